@@ -0,0 +1,406 @@
+/*
+  ==============================================================================
+
+    Simple_eq batch renderer.
+
+    Applies a saved Simple_eq state to audio files without a host:
+
+        Simple_eq_BatchRenderer --state=preset.bin --out=rendered [--threads=N] [--block=N] files-or-folders...
+
+    The state blob is what the plugin's getStateInformation() writes, in the
+    binary format or the state tree older versions saved. Every file
+    is streamed through one MonoChain per channel and the enabled parametric
+    bands in fixed-size blocks, so memory use per file stays the same however
+    long the file is, and files are rendered concurrently on a thread pool.
+
+    Files found in a folder keep their path below that folder under --out.
+    Nothing is rendered if two files would be written to the same place or
+    a file would be written over one of the inputs.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include "../../Source/FilterChain.h"
+#include "../../Source/ParametricBandEngine.h"
+#include "../../Source/BinaryState.h"
+
+
+namespace
+{
+	juce::CriticalSection consoleLock;
+
+	void printLine(const juce::String& text)
+	{
+		const juce::ScopedLock sl(consoleLock);
+		std::cout << text << std::endl;
+	}
+
+
+	struct RenderOptions
+	{
+		ChainSettings chainSettings;
+		std::array<BandSettings, maxParametricBands> bandSettings;
+		juce::File outputDirectory;
+		int blockSize = 4096;
+	};
+
+
+	struct RenderInput
+	{
+		juce::File source, output;
+	};
+
+
+	class RenderJob : public juce::ThreadPoolJob
+	{
+	public:
+		RenderJob(const RenderInput& input, const RenderOptions& renderOptions, std::atomic<int>& failureCount)
+			: juce::ThreadPoolJob(input.source.getFileName()),
+			  source(input.source),
+			  outputFile(input.output),
+			  options(renderOptions),
+			  numFailed(failureCount)
+		{
+		}
+
+		JobStatus runJob() override
+		{
+			juce::ScopedNoDenormals noDenormals;
+			juce::String error;
+
+			if (render(error))
+			{
+				printLine("rendered " + source.getFullPathName());
+			}
+			else
+			{
+				++numFailed;
+				printLine("FAILED   " + source.getFullPathName() + ": " + error);
+			}
+
+			return jobHasFinished;
+		}
+
+	private:
+		// Windows of this many blocks are memory-mapped at a time.
+		static constexpr int blocksPerMappedWindow = 64;
+
+		bool render(juce::String& error)
+		{
+			juce::AudioFormatManager formats;
+			formats.registerBasicFormats();
+
+			auto* format = formats.findFormatForFileExtension(source.getFileExtension());
+			if (format == nullptr)
+			{
+				error = "unsupported file type";
+				return false;
+			}
+
+			// WAV and AIFF can be memory-mapped, everything else is streamed
+			std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader(format->createMemoryMappedReader(source));
+			std::unique_ptr<juce::AudioFormatReader> streamedReader;
+
+			juce::AudioFormatReader* reader = mappedReader.get();
+			if (reader == nullptr)
+			{
+				streamedReader.reset(formats.createReaderFor(source));
+				reader = streamedReader.get();
+			}
+
+			if (reader == nullptr)
+			{
+				error = "could not open for reading";
+				return false;
+			}
+
+			const auto sampleRate = reader->sampleRate;
+			const auto numChannels = static_cast<int>(reader->numChannels);
+			const auto lengthInSamples = reader->lengthInSamples;
+
+			if (!outputFile.getParentDirectory().createDirectory())
+			{
+				error = "could not create " + outputFile.getParentDirectory().getFullPathName();
+				return false;
+			}
+
+			outputFile.deleteFile();
+
+			auto outputStream = std::make_unique<juce::FileOutputStream>(outputFile);
+			if (!outputStream->openedOk())
+			{
+				error = "could not create " + outputFile.getFullPathName();
+				return false;
+			}
+
+			std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(outputStream.get(),
+				sampleRate,
+				static_cast<unsigned int>(numChannels),
+				static_cast<int>(reader->bitsPerSample),
+				reader->metadataValues,
+				0));
+
+			if (writer == nullptr)
+			{
+				error = "could not create a writer";
+				return false;
+			}
+
+			outputStream.release();   // now owned by the writer
+
+			juce::OwnedArray<MonoChain> chains;
+			prepareChains(chains, numChannels, sampleRate);
+
+			ParametricBandEngine<float> bands;
+			prepareBands(bands, numChannels, sampleRate);
+
+			juce::AudioBuffer<float> buffer(numChannels, options.blockSize);
+			const auto mappedWindow = static_cast<juce::int64>(options.blockSize) * blocksPerMappedWindow;
+
+			for (juce::int64 position = 0; position < lengthInSamples; position += options.blockSize)
+			{
+				if (shouldExit())
+				{
+					error = "cancelled";
+					return false;
+				}
+
+				const auto numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(options.blockSize), lengthInSamples - position));
+
+				if (mappedReader != nullptr
+				 && !mappedReader->getMappedSection().contains(juce::Range<juce::int64>(position, position + numSamples)))
+				{
+					if (!mappedReader->mapSectionOfFile({ position, juce::jmin(lengthInSamples, position + mappedWindow) }))
+					{
+						error = "could not map the file";
+						return false;
+					}
+				}
+
+				if (!reader->read(&buffer, 0, numSamples, position, true, true))
+				{
+					error = "read error";
+					return false;
+				}
+
+				juce::dsp::AudioBlock<float> block(buffer);
+				auto subBlock = block.getSubBlock(0, static_cast<size_t>(numSamples));
+
+				for (int ch = 0; ch < numChannels; ch++)
+				{
+					auto channelBlock = subBlock.getSingleChannelBlock(static_cast<size_t>(ch));
+					juce::dsp::ProcessContextReplacing<float> context(channelBlock);
+					chains[ch]->process(context);
+				}
+
+				if (bands.hasActiveBands())
+					bands.process(subBlock, 0);
+
+				if (!writer->writeFromAudioSampleBuffer(buffer, 0, numSamples))
+				{
+					error = "write error";
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		void prepareChains(juce::OwnedArray<MonoChain>& chains, int numChannels, double sampleRate) const
+		{
+			juce::dsp::ProcessSpec spec;
+
+			spec.maximumBlockSize = static_cast<juce::uint32>(options.blockSize);
+			spec.numChannels = 1;
+			spec.sampleRate = sampleRate;
+
+			const auto& chainSettings = options.chainSettings;
+
+			auto peakCoefficients = makePeakFilter(chainSettings, sampleRate);
+			auto loCutCoefficients = makeLoCutFilter(chainSettings, sampleRate);
+			auto hiCutCoefficients = makeHiCutFilter(chainSettings, sampleRate);
+
+			for (int ch = 0; ch < numChannels; ch++)
+			{
+				auto* chain = chains.add(new MonoChain());
+				chain->prepare(spec);
+
+				updateCoefficients(chain->get<ChainPositions::Peak>().coefficients, peakCoefficients);
+				updateCutFilter(chain->get<ChainPositions::LoCut>(), loCutCoefficients, chainSettings.loCutSlope);
+				updateCutFilter(chain->get<ChainPositions::HiCut>(), hiCutCoefficients, chainSettings.hiCutSlope);
+			}
+		}
+
+		void prepareBands(ParametricBandEngine<float>& bands, int numChannels, double sampleRate) const
+		{
+			BandCoefficientArray coefficients;
+			juce::uint32 enabledBands = 0;
+
+			for (int band = 0; band < maxParametricBands; band++)
+			{
+				const auto& settings = options.bandSettings[static_cast<size_t>(band)];
+				designBand(coefficients[static_cast<size_t>(band)].data(), settings, sampleRate);
+
+				if (settings.enabled)
+					enabledBands |= 1u << band;
+			}
+
+			bands.prepare(numChannels);
+			bands.setBands(coefficients, enabledBands);
+		}
+
+		juce::File source, outputFile;
+		const RenderOptions& options;
+		std::atomic<int>& numFailed;
+	};
+
+
+	void printUsage()
+	{
+		std::cout << "Usage: Simple_eq_BatchRenderer --state=<state file> --out=<folder> [--threads=N] [--block=N] <files or folders>..." << std::endl
+		          << "  --state    a state blob as saved by the plugin (getStateInformation)" << std::endl
+		          << "  --out      folder for the rendered files, created if needed" << std::endl
+		          << "  --threads  number of files rendered at once (default: number of cores)" << std::endl
+		          << "  --block    samples per processing block (default: 4096)" << std::endl
+		          << "Folders are searched recursively for .wav, .aif, .aiff and .flac files, and each one" << std::endl
+		          << "is written to the same path relative to the folder under --out. Nothing is rendered" << std::endl
+		          << "if two files would be written to the same place or over an input." << std::endl;
+	}
+
+
+	std::vector<RenderInput> collectInputs(const juce::ArgumentList& args, const juce::File& outputDirectory)
+	{
+		std::vector<RenderInput> inputs;
+
+		for (const auto& arg : args.arguments)
+		{
+			if (arg.isOption())
+				continue;
+
+			auto file = arg.resolveAsFile();
+
+			if (file.isDirectory())
+			{
+				for (const auto& child : file.findChildFiles(juce::File::findFiles, true, "*.wav;*.aif;*.aiff;*.flac"))
+					inputs.push_back({ child, outputDirectory.getChildFile(child.getRelativePathFrom(file)) });
+			}
+			else if (file.existsAsFile())
+			{
+				inputs.push_back({ file, outputDirectory.getChildFile(file.getFileName()) });
+			}
+			else
+			{
+				juce::ConsoleApplication::fail("no such file: " + arg.text);
+			}
+		}
+
+		return inputs;
+	}
+
+
+	// Before any job starts: jobs writing the same file would race, and an input written over
+	// would be deleted before it is read.
+	void checkOutputPaths(const std::vector<RenderInput>& inputs)
+	{
+		auto getKey = [](const juce::File& file)
+		{
+			const auto path = file.getFullPathName();
+			return juce::File::areFileNamesCaseSensitive() ? path : path.toLowerCase();
+		};
+
+		std::unordered_map<juce::String, const RenderInput*> byOutput;
+		std::unordered_set<juce::String> sources;
+
+		for (const auto& input : inputs)
+			sources.insert(getKey(input.source));
+
+		for (const auto& input : inputs)
+		{
+			const auto key = getKey(input.output);
+
+			if (sources.count(key) > 0)
+				juce::ConsoleApplication::fail(input.source.getFullPathName() + " would be written over the input "
+				                               + input.output.getFullPathName() + "; choose another --out");
+
+			const auto [it, inserted] = byOutput.emplace(key, &input);
+			if (!inserted)
+				juce::ConsoleApplication::fail(it->second->source.getFullPathName() + " and " + input.source.getFullPathName()
+				                               + " would both be written to " + input.output.getFullPathName());
+		}
+	}
+
+
+	int runBatch(const juce::ArgumentList& args)
+	{
+		auto stateFile = args.getExistingFileForOption("--state");
+
+		juce::MemoryBlock stateData;
+		if (!stateFile.loadFileAsData(stateData))
+			juce::ConsoleApplication::fail("could not read " + stateFile.getFullPathName());
+
+		// States saved before the binary format hold the whole state tree
+		auto state = isBinaryState(stateData.getData(), static_cast<int>(stateData.getSize()))
+			? getBinaryStateParameters(stateData.getData(), static_cast<int>(stateData.getSize()))
+			: juce::ValueTree::readFromData(stateData.getData(), stateData.getSize());
+
+		if (!state.isValid())
+			juce::ConsoleApplication::fail(stateFile.getFullPathName() + " is not a Simple_eq state");
+
+		RenderOptions options;
+		options.chainSettings = getChainSettings(state);
+		for (int band = 0; band < maxParametricBands; band++)
+			options.bandSettings[static_cast<size_t>(band)] = getBandSettings(state, band);
+		options.outputDirectory = args.getFileForOption("--out");
+		options.blockSize = juce::jlimit(32, 65536, args.getValueForOption("--block").getIntValue() > 0
+		                                                ? args.getValueForOption("--block").getIntValue()
+		                                                : 4096);
+
+		if (!options.outputDirectory.createDirectory())
+			juce::ConsoleApplication::fail("could not create " + options.outputDirectory.getFullPathName());
+
+		const auto inputs = collectInputs(args, options.outputDirectory);
+		if (inputs.empty())
+			juce::ConsoleApplication::fail("no input files");
+
+		checkOutputPaths(inputs);
+
+		const auto requestedThreads = args.getValueForOption("--threads").getIntValue();
+		const auto numThreads = requestedThreads > 0 ? requestedThreads : juce::SystemStats::getNumCpus();
+
+		std::atomic<int> numFailed{ 0 };
+
+		{
+			juce::ThreadPool pool(numThreads);
+
+			for (const auto& input : inputs)
+				pool.addJob(new RenderJob(input, options, numFailed), true);
+
+			while (pool.getNumJobs() > 0)
+				juce::Thread::sleep(50);
+		}
+
+		const auto numInputs = static_cast<int>(inputs.size());
+		printLine(juce::String(numInputs - numFailed.load()) + " of " + juce::String(numInputs) + " files rendered");
+
+		return numFailed.load() == 0 ? 0 : 1;
+	}
+}
+
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+	juce::ArgumentList args(argc, argv);
+
+	if (args.size() == 0 || args.containsOption("--help|-h"))
+	{
+		printUsage();
+		return 0;
+	}
+
+	return juce::ConsoleApplication::invokeCatchingFailures([&args] { return runBatch(args); });
+}
@@ -0,0 +1,866 @@
+/*
+  ==============================================================================
+
+    Simple_eq processBlock benchmark.
+
+    Runs a headless Simple_eqAudioProcessor over a matrix of block sizes,
+    sample rates, cut slopes and static or automated parameters, and prints
+    the results as JSON:
+
+        Simple_eq_Benchmark [--blocks=1,32,512] [--rates=44100,96000] [--slopes=12,48,96]
+                            [--all-slope-pairs] [--modes=static,automated] [--channels=2]
+                            [--backend=packed|scalar|svf] [--oversampling=1|2|4|8] [--oversampling-filter=iir|fir]
+                            [--precision=float|double|double-state] [--sub-block=16,32,64]
+                            [--dynamic-peak] [--no-reblocking] [--seconds=1] [--repeats=3] [--out=results.json]
+
+    Every case processes `seconds` of white noise once to warm up and then
+    `repeats` more times while being timed; the fastest repeat is reported.
+    Only the processBlock calls (and, when automated, the parameter changes
+    between them) are inside the timed region. --no-reblocking processes every
+    block whole and runs the per-block work on every block, to compare with the
+    chunking and the tiny-block path across the block sizes. --sub-block sets
+    how often ramping sections are redesigned; with the automated mode, the
+    results show what those redesigns cost per update and as a share of the
+    block time.
+
+        Simple_eq_Benchmark --session=200 [--rates=48000] [--blocks=512] [--out=session.json]
+
+    instead times what a host does when it opens a session with that many
+    instances: creating them, then loading the same state into each and
+    preparing it. This runs without and then with the shared coefficient cache,
+    and once more with the state in the ValueTree format older versions saved,
+    to compare its recall with the binary format's.
+
+        Simple_eq_Benchmark --designs [--rates=48000] [--slopes=12,48,96]
+
+    times one redesign of each cut cascade and of the peak, with the
+    allocation-free designers in CoefficientDesign.h and with FilterDesign /
+    IIR::Coefficients, and reports how far apart their coefficients are.
+
+        Simple_eq_Benchmark --editors=20
+
+    opens an editor on each of that many instances and reports the construction
+    time and how much the resident memory grew. For comparison with editors that
+    do not share their look-and-feel, fonts and images, the same editors are
+    first opened one at a time: with no other editor open, EditorResources is
+    created afresh for each, so each pays for everything by itself.
+
+        Simple_eq_Benchmark --knob-paint
+
+    times painting one knob, at the size the editor gives the cut sliders,
+    while its value sweeps, drawn live and from the pre-rendered body.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/PluginEditor.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+#if JUCE_LINUX
+ #include <unistd.h>
+#endif
+
+
+namespace
+{
+	// Time stamp counter on x86, which counts at the nominal clock rate rather than
+	// the current one. Elsewhere there is no portable cycle counter and 0 is returned.
+   #if JUCE_INTEL
+	constexpr bool hasCycleCounter = true;
+	juce::uint64 readCycleCounter() noexcept { return static_cast<juce::uint64>(__rdtsc()); }
+   #else
+	constexpr bool hasCycleCounter = false;
+	juce::uint64 readCycleCounter() noexcept { return 0; }
+   #endif
+
+	// Same choices as createParameterLayout()
+	const std::array<int, 6> slopeChoices{ 12, 24, 36, 48, 72, 96 };
+
+	// Hosts usually send automation once per buffer, at most every few hundred samples.
+	constexpr int automationIntervalSamples = 256;
+
+
+	// double-state is float I/O with double precision filters
+	enum class Precision
+	{
+		Float,
+		Double,
+		DoubleState
+	};
+
+
+	struct BenchmarkCase
+	{
+		int blockSize;
+		double sampleRate;
+		int loCutSlope;      // index into slopeChoices
+		int hiCutSlope;
+		bool automated;
+		int subBlockSize = 32;   // the processor's default
+	};
+
+
+	struct BenchmarkOptions
+	{
+		juce::Array<int> blockSizes{ 1, 8, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+		juce::Array<double> sampleRates{ 44100.0, 48000.0, 88200.0, 96000.0, 192000.0, 384000.0 };
+		juce::Array<int> slopes{ 0, 1, 2, 3, 4, 5 };
+		bool allSlopePairs = false;
+		juce::Array<bool> modes{ false, true };
+		juce::Array<int> subBlockSizes{ 32 };
+		int numChannels = 2;
+		ProcessingBackend backend = ProcessingBackend::Packed;
+		int oversamplingFactor = 1;
+		OversamplingFilter oversamplingFilter = OversamplingFilter::PolyphaseIIR;
+		Precision precision = Precision::Float;
+		bool dynamicPeak = false;
+		bool reblocking = true;
+		double seconds = 1.0;
+		int repeats = 3;
+	};
+
+
+	struct CaseResult
+	{
+		double nsPerSample;
+		double cyclesPerSample;
+		juce::uint64 redesigns;
+		juce::uint64 smoothedSectionUpdates;
+		double smoothingNsPerUpdate;         // 0 without updates
+		double smoothingShare;               // of the time in processBlock
+		double dynamicPeakUpdatesPerSecond;
+	};
+
+
+	void setParameter(Simple_eqAudioProcessor& processor, const juce::String& paramID, float value)
+	{
+		auto* param = processor.apvts.getParameter(paramID);
+		jassert(param != nullptr);
+
+		param->setValueNotifyingHost(param->convertTo0to1(value));
+	}
+
+
+	void setStaticParameters(Simple_eqAudioProcessor& processor, const BenchmarkCase& c)
+	{
+		setParameter(processor, "LoCut Freq", 80.f);
+		setParameter(processor, "HiCut Freq", 12000.f);
+		setParameter(processor, "Peak Freq", 1000.f);
+		setParameter(processor, "Peak Gain", 6.f);
+		setParameter(processor, "Peak Q", 1.f);
+		setParameter(processor, "LoCut Slope", static_cast<float>(c.loCutSlope));
+		setParameter(processor, "HiCut Slope", static_cast<float>(c.hiCutSlope));
+	}
+
+
+	// Slow sweeps over all continuous parameters, `phase` in cycles
+	void setAutomatedParameters(Simple_eqAudioProcessor& processor, double phase)
+	{
+		const auto s = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * phase));
+		const auto c = static_cast<float>(std::cos(juce::MathConstants<double>::twoPi * phase));
+
+		setParameter(processor, "LoCut Freq", 80.f * std::pow(2.f, 1.5f * s));
+		setParameter(processor, "HiCut Freq", 10000.f * std::pow(2.f, c));
+		setParameter(processor, "Peak Freq", 1000.f * std::pow(2.f, 2.f * c));
+		setParameter(processor, "Peak Gain", 12.f * s);
+		setParameter(processor, "Peak Q", 1.f + 0.8f * s);
+	}
+
+
+	CaseResult runCase(const BenchmarkOptions& options, const BenchmarkCase& c)
+	{
+		Simple_eqAudioProcessor processor;
+
+		const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(options.numChannels);
+		juce::AudioProcessor::BusesLayout layout;
+		layout.inputBuses.add(channelSet.isDisabled() ? juce::AudioChannelSet::discreteChannels(options.numChannels) : channelSet);
+		layout.inputBuses.add(juce::AudioChannelSet::disabled());   // sidechain
+		layout.outputBuses.add(layout.inputBuses.getReference(0));
+
+		if (!processor.setBusesLayout(layout))
+			juce::ConsoleApplication::fail("unsupported channel count " + juce::String(options.numChannels));
+
+		processor.setProcessingBackend(options.backend);
+		processor.setOversampling(options.oversamplingFactor, options.oversamplingFilter);
+		processor.setDoublePrecisionState(options.precision == Precision::DoubleState);
+		processor.setReblocking(options.reblocking);
+		processor.setSmoothingSubBlockSize(c.subBlockSize);
+		processor.setProcessingPrecision(options.precision == Precision::Double ? juce::AudioProcessor::doublePrecision
+		                                                                       : juce::AudioProcessor::singlePrecision);
+		setStaticParameters(processor, c);
+
+		// Noise at -12 dBFS sits well above this threshold, so the peak gain keeps moving
+		if (options.dynamicPeak)
+		{
+			setParameter(processor, "Peak Dynamic", 1.f);
+			setParameter(processor, "Peak Threshold", -40.f);
+			setParameter(processor, "Peak Range", -12.f);
+		}
+
+		processor.setRateAndBufferSize(c.sampleRate, c.blockSize);
+		processor.prepareToPlay(c.sampleRate, c.blockSize);
+
+		const auto numSamples = juce::jmax(c.blockSize, static_cast<int>(options.seconds * c.sampleRate));
+
+		juce::AudioBuffer<float> noise(options.numChannels, numSamples);
+		juce::AudioBuffer<float> signal(options.numChannels, numSamples);
+		juce::AudioBuffer<double> doubleSignal;
+		juce::MidiBuffer midi;
+		juce::Random random(0x5eed);
+
+		for (int ch = 0; ch < options.numChannels; ch++)
+			for (int i = 0; i < numSamples; i++)
+				noise.setSample(ch, i, 0.25f * (2.f * random.nextFloat() - 1.f));
+
+		juce::HeapBlock<float*> channelPointers(options.numChannels);
+		juce::HeapBlock<double*> doubleChannelPointers(options.numChannels);
+		const auto processDoubles = options.precision == Precision::Double;
+		const auto blocksPerAutomation = juce::jmax(1, automationIntervalSamples / c.blockSize);
+
+		// One pass over the whole signal, returning nanoseconds and cycles spent
+		auto runPass = [&]() -> std::pair<double, juce::uint64>
+		{
+			signal.makeCopyOf(noise, true);
+			if (processDoubles)
+				doubleSignal.makeCopyOf(noise, true);
+
+			const auto startTicks = juce::Time::getHighResolutionTicks();
+			const auto startCycles = readCycleCounter();
+
+			int blockIndex = 0;
+			for (int start = 0; start + c.blockSize <= numSamples; start += c.blockSize, blockIndex++)
+			{
+				if (c.automated && blockIndex % blocksPerAutomation == 0)
+					setAutomatedParameters(processor, 0.5 * start / c.sampleRate);
+
+				if (processDoubles)
+				{
+					for (int ch = 0; ch < options.numChannels; ch++)
+						doubleChannelPointers[ch] = doubleSignal.getWritePointer(ch, start);
+
+					juce::AudioBuffer<double> block(doubleChannelPointers.get(), options.numChannels, c.blockSize);
+					processor.processBlock(block, midi);
+				}
+				else
+				{
+					for (int ch = 0; ch < options.numChannels; ch++)
+						channelPointers[ch] = signal.getWritePointer(ch, start);
+
+					juce::AudioBuffer<float> block(channelPointers.get(), options.numChannels, c.blockSize);
+					processor.processBlock(block, midi);
+				}
+			}
+
+			const auto cycles = readCycleCounter() - startCycles;
+			const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+			return { seconds * 1.0e9, cycles };
+		};
+
+		const auto numProcessed = static_cast<double>((numSamples / c.blockSize) * c.blockSize);
+
+		runPass();
+
+		const auto redesignsBefore = processor.getNumCoefficientRedesigns();
+		const auto smoothingBefore = processor.getSmoothingStats();
+
+		// The smoothing stats add up over every timed pass, not just the fastest
+		auto best = runPass();
+		auto totalNs = best.first;
+
+		for (int r = 1; r < options.repeats; r++)
+		{
+			const auto pass = runPass();
+			totalNs += pass.first;
+
+			if (pass.first < best.first)
+				best = pass;
+		}
+
+		const auto smoothingAfter = processor.getSmoothingStats();
+		const auto smoothingUpdates = smoothingAfter.numSectionUpdates - smoothingBefore.numSectionUpdates;
+		const auto smoothingNs = (smoothingAfter.secondsSpent - smoothingBefore.secondsSpent) * 1.0e9;
+
+		CaseResult result;
+		result.nsPerSample = best.first / numProcessed;
+		result.cyclesPerSample = static_cast<double>(best.second) / numProcessed;
+		result.redesigns = processor.getNumCoefficientRedesigns() - redesignsBefore;
+		result.smoothedSectionUpdates = smoothingUpdates;
+		result.smoothingNsPerUpdate = smoothingUpdates > 0 ? smoothingNs / static_cast<double>(smoothingUpdates) : 0.0;
+		result.smoothingShare = totalNs > 0 ? smoothingNs / totalNs : 0.0;
+		result.dynamicPeakUpdatesPerSecond = processor.getDynamicPeakStats().updatesPerSecond;
+
+		processor.releaseResources();
+		return result;
+	}
+
+
+	template <typename ValueType, typename Parser>
+	juce::Array<ValueType> parseList(const juce::ArgumentList& args, const juce::String& option, Parser parse, const juce::Array<ValueType>& defaults)
+	{
+		if (!args.containsOption(option))
+			return defaults;
+
+		juce::Array<ValueType> values;
+		for (const auto& token : juce::StringArray::fromTokens(args.getValueForOption(option), ",", {}))
+			values.add(parse(token.trim()));
+
+		if (values.isEmpty())
+			juce::ConsoleApplication::fail(option + " needs at least one value");
+
+		return values;
+	}
+
+
+	BenchmarkOptions parseOptions(const juce::ArgumentList& args)
+	{
+		BenchmarkOptions options;
+
+		options.blockSizes = parseList<int>(args, "--blocks", [](const juce::String& s)
+		{
+			const auto size = s.getIntValue();
+			if (size < 1 || size > 8192)
+				juce::ConsoleApplication::fail("block sizes must be between 1 and 8192");
+			return size;
+		}, options.blockSizes);
+
+		options.sampleRates = parseList<double>(args, "--rates", [](const juce::String& s)
+		{
+			const auto rate = s.getDoubleValue();
+			if (rate < 8000.0 || rate > 768000.0)
+				juce::ConsoleApplication::fail("unsupported sample rate " + s);
+			return rate;
+		}, options.sampleRates);
+
+		options.slopes = parseList<int>(args, "--slopes", [](const juce::String& s)
+		{
+			const auto it = std::find(slopeChoices.begin(), slopeChoices.end(), s.getIntValue());
+			if (it == slopeChoices.end())
+				juce::ConsoleApplication::fail("slopes are given in dB/Oct: 12, 24, 36, 48, 72 or 96");
+			return static_cast<int>(std::distance(slopeChoices.begin(), it));
+		}, options.slopes);
+
+		options.modes = parseList<bool>(args, "--modes", [](const juce::String& s)
+		{
+			if (s != "static" && s != "automated")
+				juce::ConsoleApplication::fail("modes are static and automated");
+			return s == "automated";
+		}, options.modes);
+
+		options.subBlockSizes = parseList<int>(args, "--sub-block", [](const juce::String& s)
+		{
+			const auto size = s.getIntValue();
+			if (size < 1 || size > 4096)
+				juce::ConsoleApplication::fail("sub-block sizes must be between 1 and 4096");
+			return size;
+		}, options.subBlockSizes);
+
+		options.allSlopePairs = args.containsOption("--all-slope-pairs");
+
+		if (args.containsOption("--channels"))
+			options.numChannels = juce::jlimit(1, 64, args.getValueForOption("--channels").getIntValue());
+
+		if (args.containsOption("--backend"))
+		{
+			const auto backend = args.getValueForOption("--backend");
+			if (backend == "scalar")
+				options.backend = ProcessingBackend::Scalar;
+			else if (backend == "svf")
+				options.backend = ProcessingBackend::StateVariable;
+			else if (backend != "packed")
+				juce::ConsoleApplication::fail("backends are packed, scalar and svf");
+		}
+
+		if (args.containsOption("--oversampling"))
+		{
+			options.oversamplingFactor = args.getValueForOption("--oversampling").getIntValue();
+			if (options.oversamplingFactor < 1 || options.oversamplingFactor > 8 || !juce::isPowerOfTwo(options.oversamplingFactor))
+				juce::ConsoleApplication::fail("oversampling factors are 1, 2, 4 and 8");
+		}
+
+		if (args.containsOption("--oversampling-filter"))
+		{
+			const auto filter = args.getValueForOption("--oversampling-filter");
+			if (filter == "fir")
+				options.oversamplingFilter = OversamplingFilter::PolyphaseFIR;
+			else if (filter != "iir")
+				juce::ConsoleApplication::fail("oversampling filters are iir and fir");
+		}
+
+		if (args.containsOption("--precision"))
+		{
+			const auto precision = args.getValueForOption("--precision");
+			if (precision == "double")
+				options.precision = Precision::Double;
+			else if (precision == "double-state")
+				options.precision = Precision::DoubleState;
+			else if (precision != "float")
+				juce::ConsoleApplication::fail("precisions are float, double and double-state");
+		}
+
+		options.dynamicPeak = args.containsOption("--dynamic-peak");
+		options.reblocking = !args.containsOption("--no-reblocking");
+
+		if (args.containsOption("--seconds"))
+			options.seconds = juce::jlimit(0.01, 60.0, args.getValueForOption("--seconds").getDoubleValue());
+
+		if (args.containsOption("--repeats"))
+			options.repeats = juce::jlimit(1, 100, args.getValueForOption("--repeats").getIntValue());
+
+		return options;
+	}
+
+
+	struct SessionResult
+	{
+		double instantiationSeconds;
+		double loadSeconds;
+		double recallSeconds;    // the setStateInformation calls alone, part of loadSeconds
+		size_t stateBytes;
+		CoefficientCache::Stats cacheStats;
+	};
+
+
+	SessionResult runSessionLoad(const BenchmarkOptions& options, int numInstances, bool useCache, bool treeState = false)
+	{
+		const auto sampleRate = options.sampleRates.getFirst();
+		const auto blockSize = options.blockSizes.getFirst();
+
+		// Steep cuts on both sides, so every miss costs two full cascade designs
+		juce::MemoryBlock state;
+		{
+			Simple_eqAudioProcessor reference;
+			setStaticParameters(reference, { blockSize, sampleRate, 5, 5, false });
+
+			if (treeState)
+			{
+				juce::MemoryOutputStream mos(state, false);
+				reference.apvts.copyState().writeToStream(mos);
+			}
+			else
+			{
+				reference.getStateInformation(state);
+			}
+		}
+
+		CoefficientCache::setEnabled(useCache);
+
+		std::vector<std::unique_ptr<Simple_eqAudioProcessor>> instances;
+		instances.reserve(static_cast<size_t>(numInstances));
+
+		const auto startTicks = juce::Time::getHighResolutionTicks();
+
+		for (int i = 0; i < numInstances; i++)
+			instances.push_back(std::make_unique<Simple_eqAudioProcessor>());
+
+		const auto createdTicks = juce::Time::getHighResolutionTicks();
+
+		for (auto& processor : instances)
+			processor->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+		const auto recalledTicks = juce::Time::getHighResolutionTicks();
+
+		for (auto& processor : instances)
+		{
+			processor->setRateAndBufferSize(sampleRate, blockSize);
+			processor->prepareToPlay(sampleRate, blockSize);
+		}
+
+		const auto loadedTicks = juce::Time::getHighResolutionTicks();
+
+		SessionResult result;
+		result.instantiationSeconds = juce::Time::highResolutionTicksToSeconds(createdTicks - startTicks);
+		result.loadSeconds = juce::Time::highResolutionTicksToSeconds(loadedTicks - createdTicks);
+		result.recallSeconds = juce::Time::highResolutionTicksToSeconds(recalledTicks - createdTicks);
+		result.stateBytes = state.getSize();
+		result.cacheStats = instances.front()->getCoefficientCacheStats();
+
+		for (auto& processor : instances)
+			processor->releaseResources();
+
+		CoefficientCache::setEnabled(true);
+		return result;
+	}
+
+
+	juce::var describeSessionResult(const SessionResult& result)
+	{
+		auto* entry = new juce::DynamicObject();
+
+		entry->setProperty("instantiation_seconds", result.instantiationSeconds);
+		entry->setProperty("load_seconds", result.loadSeconds);
+		entry->setProperty("recall_seconds", result.recallSeconds);
+		entry->setProperty("state_bytes", static_cast<juce::int64>(result.stateBytes));
+		entry->setProperty("cache_hits", static_cast<juce::int64>(result.cacheStats.hits));
+		entry->setProperty("cache_misses", static_cast<juce::int64>(result.cacheStats.misses));
+		entry->setProperty("cache_evictions", static_cast<juce::int64>(result.cacheStats.evictions));
+		entry->setProperty("cache_entries", result.cacheStats.numEntries);
+
+		return entry;
+	}
+
+
+	// Resident set size of the process, or -1 where it is not read
+	juce::int64 getResidentMemoryBytes()
+	{
+	   #if JUCE_LINUX
+		const auto fields = juce::StringArray::fromTokens(juce::File("/proc/self/statm").loadFileAsString(), false);
+		if (fields.size() > 1)
+			return fields[1].getLargeIntValue() * static_cast<juce::int64>(sysconf(_SC_PAGESIZE));
+	   #endif
+		return -1;
+	}
+
+
+	// Alone, each editor is the only holder of EditorResources and creates it from scratch,
+	// as every editor did before they shared it. The memory is what the first one added:
+	// later ones reuse what the allocator kept from the one before.
+	juce::var runEditorLoad(int numEditors, bool alone)
+	{
+		std::vector<std::unique_ptr<Simple_eqAudioProcessor>> instances;
+		for (int i = 0; i < numEditors; i++)
+			instances.push_back(std::make_unique<Simple_eqAudioProcessor>());
+
+		std::vector<std::unique_ptr<juce::AudioProcessorEditor>> editors;
+		editors.reserve(static_cast<size_t>(numEditors));
+
+		const auto memoryBefore = getResidentMemoryBytes();
+		auto memoryAfter = memoryBefore;
+		double seconds = 0;
+
+		for (auto& processor : instances)
+		{
+			const auto startTicks = juce::Time::getHighResolutionTicks();
+			editors.emplace_back(processor->createEditor());
+			seconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+			if (!alone || &processor == &instances.front())
+				memoryAfter = getResidentMemoryBytes();
+
+			if (alone)
+				editors.clear();
+		}
+
+		editors.clear();
+
+		const auto numMeasured = alone ? 1 : numEditors;
+
+		auto* entry = new juce::DynamicObject();
+		entry->setProperty("construction_ms_per_editor", seconds * 1000 / numEditors);
+		entry->setProperty("resident_bytes_per_editor", memoryBefore >= 0 ? juce::var((memoryAfter - memoryBefore) / numMeasured) : juce::var());
+
+		return entry;
+	}
+
+
+	juce::var runKnobPaintTimings()
+	{
+		constexpr int numPaints = 5000;
+
+		Simple_eqAudioProcessor processor;
+		auto& parameter = *processor.apvts.getParameter("LoCut Freq");
+
+		RotarySliderWithLabels slider(parameter, "Hz");
+		slider.setNormalisableRange({ 20.0, 20000.0 });
+		slider.labels.add({ 0.f, "20Hz" });
+		slider.labels.add({ 1.f, "20kHz" });
+		slider.setBounds(0, 0, 198, 148);
+
+		juce::Image target(juce::Image::PixelFormat::ARGB, slider.getWidth(), slider.getHeight(), true);
+
+		auto timePaints = [&](bool useImages)
+		{
+			slider.setUseKnobImages(useImages);
+
+			const auto startTicks = juce::Time::getHighResolutionTicks();
+
+			for (int i = 0; i < numPaints; i++)
+			{
+				slider.setValue(20.0 + 19980.0 * (i % 1000) / 1000.0, juce::dontSendNotification);
+
+				juce::Graphics g(target);
+				slider.paint(g);
+			}
+
+			return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e6 / numPaints;
+		};
+
+		auto* paint = new juce::DynamicObject();
+		paint->setProperty("width", slider.getWidth());
+		paint->setProperty("height", slider.getHeight());
+		paint->setProperty("live_us_per_paint", timePaints(false));
+		paint->setProperty("image_us_per_paint", timePaints(true));
+
+		return paint;
+	}
+
+
+	juce::var runDesignTimings(const BenchmarkOptions& options)
+	{
+		constexpr int numDesigns = 100000;
+		const auto sampleRate = options.sampleRates.getFirst();
+
+		std::array<float, 5 * maxButterworthSections> sections{};
+		float sink = 0;
+
+		// Sweeps 20 Hz to 20 kHz, so neither side gets to reuse a result
+		auto getFrequency = [](int i) { return 20.f * std::pow(1000.f, static_cast<float>(i % 1000) / 1000.f); };
+
+		auto timeDesigns = [&getFrequency](auto&& design)
+		{
+			const auto startTicks = juce::Time::getHighResolutionTicks();
+
+			for (int i = 0; i < numDesigns; i++)
+				design(getFrequency(i));
+
+			return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e9 / numDesigns;
+		};
+
+		auto maxDifference = [](const float* a, const float* b, int numValues)
+		{
+			float difference = 0;
+			for (int i = 0; i < numValues; i++)
+				difference = juce::jmax(difference, std::abs(a[i] - b[i]));
+			return difference;
+		};
+
+		juce::Array<juce::var> cuts;
+
+		for (auto slope : options.slopes)
+		{
+			const auto order = getCutFilterOrder(slope);
+			auto getSection = [&sections](int i) { return sections.data() + 5 * i; };
+
+			auto* entry = new juce::DynamicObject();
+			entry->setProperty("slope", slopeChoices[static_cast<size_t>(slope)]);
+
+			entry->setProperty("in_house_ns", timeDesigns([&](float f)
+			{
+				designCutFilter(getSection, true, sampleRate, f, order);
+				sink += sections[0];
+			}));
+
+			entry->setProperty("filter_design_ns", timeDesigns([&](float f)
+			{
+				auto designed = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(f, sampleRate, order);
+				sink += designed.getFirst()->coefficients[0];
+			}));
+
+			float difference = 0;
+			for (int i = 0; i < 1000; i++)
+			{
+				designCutFilter(getSection, true, sampleRate, getFrequency(i), order);
+				const auto designed = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(getFrequency(i), sampleRate, order);
+
+				for (int section = 0; section < designed.size(); section++)
+					difference = juce::jmax(difference, maxDifference(getSection(section), designed[section]->getRawCoefficients(), 5));
+			}
+
+			entry->setProperty("max_coefficient_difference", difference);
+			cuts.add(entry);
+		}
+
+		auto* peak = new juce::DynamicObject();
+
+		peak->setProperty("in_house_ns", timeDesigns([&](float f)
+		{
+			designPeakSection(sections.data(), sampleRate, f, 1.f, 2.f);
+			sink += sections[0];
+		}));
+
+		peak->setProperty("filter_design_ns", timeDesigns([&](float f)
+		{
+			auto designed = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, f, 1.f, 2.f);
+			sink += designed->coefficients[0];
+		}));
+
+		float difference = 0;
+		for (int i = 0; i < 1000; i++)
+		{
+			designPeakSection(sections.data(), sampleRate, getFrequency(i), 1.f, 2.f);
+			const auto designed = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, getFrequency(i), 1.f, 2.f);
+			difference = juce::jmax(difference, maxDifference(sections.data(), designed->getRawCoefficients(), 5));
+		}
+
+		peak->setProperty("max_coefficient_difference", difference);
+
+		auto* designs = new juce::DynamicObject();
+		designs->setProperty("sample_rate", sampleRate);
+		designs->setProperty("cuts", cuts);
+		designs->setProperty("peak", peak);
+		designs->setProperty("checksum", sink);   // keeps the designs from being optimised away
+
+		return designs;
+	}
+
+
+	juce::Array<BenchmarkCase> makeCases(const BenchmarkOptions& options)
+	{
+		juce::Array<BenchmarkCase> cases;
+
+		for (auto automated : options.modes)
+			for (auto sampleRate : options.sampleRates)
+				for (auto loCutSlope : options.slopes)
+					for (auto hiCutSlope : options.slopes)
+					{
+						if (!options.allSlopePairs && hiCutSlope != loCutSlope)
+							continue;
+
+						for (auto blockSize : options.blockSizes)
+							for (auto subBlockSize : options.subBlockSizes)
+								cases.add({ blockSize, sampleRate, loCutSlope, hiCutSlope, automated, subBlockSize });
+					}
+
+		return cases;
+	}
+
+
+	juce::var describeMachine(const BenchmarkOptions& options)
+	{
+		auto* info = new juce::DynamicObject();
+
+		info->setProperty("cpu", juce::SystemStats::getCpuModel());
+		info->setProperty("cpu_mhz", juce::SystemStats::getCpuSpeedInMegahertz());
+		info->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+		info->setProperty("os", juce::SystemStats::getOperatingSystemName());
+		info->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+		info->setProperty("simd", JUCE_USE_SIMD != 0);
+		info->setProperty("backend", options.backend == ProcessingBackend::Packed ? "packed"
+		                           : options.backend == ProcessingBackend::Scalar ? "scalar" : "svf");
+		info->setProperty("channels", options.numChannels);
+		info->setProperty("oversampling", options.oversamplingFactor);
+		info->setProperty("precision", options.precision == Precision::Float ? "float"
+		                             : options.precision == Precision::Double ? "double" : "double-state");
+		info->setProperty("oversampling_filter", options.oversamplingFilter == OversamplingFilter::PolyphaseIIR ? "iir" : "fir");
+		info->setProperty("dynamic_peak", options.dynamicPeak);
+		info->setProperty("seconds_per_case", options.seconds);
+		info->setProperty("repeats", options.repeats);
+		info->setProperty("automation_interval_samples", automationIntervalSamples);
+		info->setProperty("cycle_counter", hasCycleCounter ? "tsc" : "none");
+
+		return info;
+	}
+
+
+	int runBenchmarks(const juce::ArgumentList& args)
+	{
+		const auto options = parseOptions(args);
+		const auto cases = makeCases(options);
+
+		auto* root = new juce::DynamicObject();
+		root->setProperty("machine", describeMachine(options));
+
+		if (args.containsOption("--session"))
+		{
+			const auto numInstances = juce::jlimit(1, 10000, args.getValueForOption("--session").getIntValue());
+
+			auto* session = new juce::DynamicObject();
+			session->setProperty("instances", numInstances);
+			session->setProperty("without_cache", describeSessionResult(runSessionLoad(options, numInstances, false)));
+			session->setProperty("with_cache", describeSessionResult(runSessionLoad(options, numInstances, true)));
+			session->setProperty("tree_state", describeSessionResult(runSessionLoad(options, numInstances, true, true)));
+			root->setProperty("session", session);
+		}
+		else if (args.containsOption("--designs"))
+		{
+			root->setProperty("designs", runDesignTimings(options));
+		}
+		else if (args.containsOption("--knob-paint"))
+		{
+			root->setProperty("knob_paint", runKnobPaintTimings());
+		}
+		else if (args.containsOption("--editors"))
+		{
+			const auto numEditors = juce::jlimit(1, 1000, args.getValueForOption("--editors").getIntValue());
+
+			auto* editors = new juce::DynamicObject();
+			editors->setProperty("editors", numEditors);
+			editors->setProperty("one_at_a_time", runEditorLoad(numEditors, true));
+			editors->setProperty("all_open", runEditorLoad(numEditors, false));
+			root->setProperty("editors", editors);
+		}
+		else
+		{
+			juce::Array<juce::var> results;
+
+			for (int i = 0; i < cases.size(); i++)
+			{
+				const auto& c = cases.getReference(i);
+				const auto result = runCase(options, c);
+
+				auto* entry = new juce::DynamicObject();
+				entry->setProperty("block_size", c.blockSize);
+				entry->setProperty("sample_rate", c.sampleRate);
+				entry->setProperty("locut_slope", slopeChoices[static_cast<size_t>(c.loCutSlope)]);
+				entry->setProperty("hicut_slope", slopeChoices[static_cast<size_t>(c.hiCutSlope)]);
+				entry->setProperty("parameters", c.automated ? "automated" : "static");
+				entry->setProperty("sub_block_size", c.subBlockSize);
+				entry->setProperty("ns_per_sample", result.nsPerSample);
+				entry->setProperty("cycles_per_sample", hasCycleCounter ? juce::var(result.cyclesPerSample) : juce::var());
+				entry->setProperty("coefficient_redesigns", static_cast<juce::int64>(result.redesigns));
+				entry->setProperty("smoothed_section_updates", static_cast<juce::int64>(result.smoothedSectionUpdates));
+				entry->setProperty("smoothing_ns_per_update", result.smoothingNsPerUpdate);
+				entry->setProperty("smoothing_share", result.smoothingShare);
+				entry->setProperty("dynamic_peak_updates_per_second", result.dynamicPeakUpdatesPerSecond);
+				results.add(entry);
+
+				std::cerr << "\r" << (i + 1) << "/" << cases.size() << std::flush;
+			}
+
+			std::cerr << std::endl;
+			root->setProperty("results", results);
+		}
+
+		const auto json = juce::JSON::toString(juce::var(root));
+
+		if (args.containsOption("--out"))
+		{
+			auto outputFile = args.getFileForOption("--out");
+			if (!outputFile.replaceWithText(json))
+				juce::ConsoleApplication::fail("could not write " + outputFile.getFullPathName());
+		}
+		else
+		{
+			std::cout << json << std::endl;
+		}
+
+		return 0;
+	}
+}
+
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+	juce::ArgumentList args(argc, argv);
+
+	if (args.containsOption("--help|-h"))
+	{
+		std::cout << "Usage: Simple_eq_Benchmark [--blocks=1,32,512] [--rates=44100,96000] [--slopes=12,48,96] [--all-slope-pairs]" << std::endl
+		          << "                           [--modes=static,automated] [--channels=2] [--backend=packed|scalar|svf]" << std::endl
+		          << "                           [--oversampling=1|2|4|8] [--oversampling-filter=iir|fir]" << std::endl
+		          << "                           [--precision=float|double|double-state]" << std::endl
+		          << "                           [--sub-block=16,32,64] [--dynamic-peak] [--no-reblocking]" << std::endl
+		          << "                           [--seconds=1] [--repeats=3] [--out=results.json]" << std::endl
+		          << "       Simple_eq_Benchmark --session=200 [--rates=48000] [--blocks=512] [--out=session.json]" << std::endl
+		          << "       Simple_eq_Benchmark --designs [--rates=48000] [--slopes=12,48,96]" << std::endl
+		          << "       Simple_eq_Benchmark --editors=20 [--out=editors.json]" << std::endl
+		          << "       Simple_eq_Benchmark --knob-paint" << std::endl;
+		return 0;
+	}
+
+	// The parameter tree and the designer thread expect a message manager to exist
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+	return juce::ConsoleApplication::invokeCatchingFailures([&args] { return runBenchmarks(args); });
+}
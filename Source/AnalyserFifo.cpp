@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    AnalyserFifo.cpp
+
+  ==============================================================================
+*/
+
+#include "AnalyserFifo.h"
+
+
+AnalyserFifo::AnalyserFifo()
+	: samples(static_cast<size_t>(capacity), 0.f)
+{
+}
+
+
+void AnalyserFifo::push(const juce::AudioBuffer<float>& buffer) noexcept
+{
+	pushMix(buffer);
+}
+
+
+void AnalyserFifo::push(const juce::AudioBuffer<double>& buffer) noexcept
+{
+	pushMix(buffer);
+}
+
+
+template <typename SampleType>
+void AnalyserFifo::pushMix(const juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+	if (!active.load(std::memory_order_relaxed))
+		return;
+
+	const auto numChannels = buffer.getNumChannels();
+	if (numChannels == 0)
+		return;
+
+	const auto numSamples = juce::jmin(buffer.getNumSamples(), fifo.getFreeSpace());
+	const auto gain = 1.f / static_cast<float>(numChannels);
+
+	int start1, size1, start2, size2;
+	fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+	auto mixInto = [&](int fifoStart, int bufferStart, int num)
+	{
+		auto* destination = samples.data() + fifoStart;
+
+		if constexpr (std::is_same_v<SampleType, float>)
+		{
+			juce::FloatVectorOperations::copyWithMultiply(destination, buffer.getReadPointer(0, bufferStart), gain, num);
+
+			for (int ch = 1; ch < numChannels; ch++)
+				juce::FloatVectorOperations::addWithMultiply(destination, buffer.getReadPointer(ch, bufferStart), gain, num);
+		}
+		else
+		{
+			std::fill_n(destination, num, 0.f);
+
+			for (int ch = 0; ch < numChannels; ch++)
+			{
+				const auto* source = buffer.getReadPointer(ch, bufferStart);
+				for (int i = 0; i < num; i++)
+					destination[i] += static_cast<float>(source[i]) * gain;
+			}
+		}
+	};
+
+	if (size1 > 0)
+		mixInto(start1, 0, size1);
+	if (size2 > 0)
+		mixInto(start2, size1, size2);
+
+	fifo.finishedWrite(size1 + size2);
+}
+
+
+int AnalyserFifo::pop(float* destination, int maxNumSamples) noexcept
+{
+	int start1, size1, start2, size2;
+	fifo.prepareToRead(maxNumSamples, start1, size1, start2, size2);
+
+	if (size1 > 0)
+		std::copy_n(samples.data() + start1, size1, destination);
+	if (size2 > 0)
+		std::copy_n(samples.data() + start2, size2, destination + size1);
+
+	fifo.finishedRead(size1 + size2);
+	return size1 + size2;
+}
+
+
+void AnalyserFifo::discardAll() noexcept
+{
+	fifo.finishedRead(fifo.getNumReady());
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    AnalyserFifo.h
+
+    Carries a mono mix of the audio from processBlock to the spectrum
+    analyser thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+/**
+	Single producer, single consumer. The audio thread pushes, the analyser thread pops,
+	and neither waits: whatever does not fit because the reader fell behind is dropped.
+
+	The buffer is allocated once in the constructor. Until a reader calls setActive(true)
+	push() returns straight away, so with the editor closed the analysis costs one
+	atomic load per block.
+*/
+class AnalyserFifo
+{
+public:
+	AnalyserFifo();
+
+	// prepareToPlay
+	void prepare(double sampleRate) { currentSampleRate.store(sampleRate); }
+
+	// Audio thread. Averages all channels of the buffer into one.
+	void push(const juce::AudioBuffer<float>& buffer) noexcept;
+	void push(const juce::AudioBuffer<double>& buffer) noexcept;
+
+	// Reader side
+	void setActive(bool shouldBeActive) { active.store(shouldBeActive); }
+	bool isActive() const { return active.load(); }
+
+	int pop(float* destination, int maxNumSamples) noexcept;
+	void discardAll() noexcept;
+
+	double getSampleRate() const { return currentSampleRate.load(); }
+
+private:
+	template <typename SampleType>
+	void pushMix(const juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+	static constexpr int capacity = 1 << 15;
+
+	juce::AbstractFifo fifo{ capacity };
+	std::vector<float> samples;
+
+	std::atomic<bool> active{ false };
+	std::atomic<double> currentSampleRate{ 44100.0 };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalyserFifo)
+};
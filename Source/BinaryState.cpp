@@ -0,0 +1,216 @@
+/*
+  ==============================================================================
+
+    BinaryState.cpp
+
+  ==============================================================================
+*/
+
+#include "BinaryState.h"
+#include <unordered_map>
+
+
+namespace
+{
+	constexpr juce::uint32 magic = 0x42514553;    // "SEQB" in little endian
+	constexpr int currentVersion = 1;
+
+	constexpr int headerSize = 12;
+	constexpr int settingsSize = 12;
+
+	enum Flags
+	{
+		stateVariableFiltersFlag = 1,
+		doublePrecisionStateFlag = 2
+	};
+
+	juce::String getParameterID(const juce::AudioProcessorParameter* parameter)
+	{
+		if (auto* withID = dynamic_cast<const juce::AudioProcessorParameterWithID*>(parameter))
+			return withID->paramID;
+
+		return {};
+	}
+
+	// FNV-1a over the IDs, each followed by its terminating zero
+	juce::uint32 getLayoutHash(const juce::Array<juce::AudioProcessorParameter*>& parameters)
+	{
+		juce::uint32 hash = 2166136261u;
+
+		for (auto* parameter : parameters)
+		{
+			const auto id = getParameterID(parameter);
+
+			for (auto* c = id.toRawUTF8(); ; c++)
+			{
+				hash = (hash ^ static_cast<juce::uint8>(*c)) * 16777619u;
+				if (*c == 0)
+					break;
+			}
+		}
+
+		return hash;
+	}
+
+	// The value in the parameter's own range, the way the state tree stores it
+	float getPlainValue(const juce::AudioProcessorParameter& parameter)
+	{
+		if (auto* ranged = dynamic_cast<const juce::RangedAudioParameter*>(&parameter))
+			return ranged->convertFrom0to1(ranged->getValue());
+
+		return parameter.getValue();
+	}
+
+	// Only the parameters that differ, each with the notification replaceState would send too
+	void applyValue(juce::AudioProcessorParameter& parameter, float plainValue)
+	{
+		if (!std::isfinite(plainValue))
+			return;
+
+		auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(&parameter);
+		const auto value = juce::jlimit(0.f, 1.f, ranged != nullptr ? ranged->convertTo0to1(plainValue) : plainValue);
+
+		if (parameter.getValue() != value)
+			parameter.setValueNotifyingHost(value);
+	}
+}
+
+
+bool isBinaryState(const void* data, int sizeInBytes)
+{
+	return data != nullptr && sizeInBytes >= headerSize
+		&& juce::ByteOrder::littleEndianInt(data) == magic;
+}
+
+
+namespace
+{
+	struct Header
+	{
+		int numStored = 0;
+		juce::uint32 layoutHash = 0;
+	};
+
+	// Leaves the stream at the first value
+	bool readHeader(juce::MemoryInputStream& in, int sizeInBytes, Header& header, StateSettings& settings)
+	{
+		if (!isBinaryState(in.getData(), sizeInBytes))
+			return false;
+
+		in.skipNextBytes(4);
+
+		const auto version = static_cast<int>(static_cast<juce::uint16>(in.readShort()));
+		header.numStored = static_cast<int>(static_cast<juce::uint16>(in.readShort()));
+		header.layoutHash = static_cast<juce::uint32>(in.readInt());
+
+		if (version < 1 || version > currentVersion || sizeInBytes < headerSize + settingsSize + header.numStored * 4)
+			return false;
+
+		settings.phaseMode = static_cast<juce::uint8>(in.readByte());
+		settings.oversamplingFactor = static_cast<juce::uint8>(in.readByte());
+		settings.oversamplingFilter = static_cast<juce::uint8>(in.readByte());
+
+		const auto flags = static_cast<juce::uint8>(in.readByte());
+		settings.stateVariableFilters = (flags & stateVariableFiltersFlag) != 0;
+		settings.doublePrecisionState = (flags & doublePrecisionStateFlag) != 0;
+
+		settings.linearPhaseKernelLength = in.readInt();
+		settings.linearPhasePartitionSize = in.readInt();
+
+		return true;
+	}
+
+	// Pairs each stored value with its ID from the table after the values
+	template <typename Function>
+	void forEachStoredValue(juce::MemoryInputStream& in, const Header& header, Function&& function)
+	{
+		std::vector<float> values(static_cast<size_t>(header.numStored));
+		for (auto& value : values)
+			value = in.readFloat();
+
+		for (const auto value : values)
+		{
+			if (in.isExhausted())
+				break;
+
+			function(in.readString(), value);
+		}
+	}
+}
+
+
+void writeBinaryState(juce::MemoryBlock& destination, const juce::Array<juce::AudioProcessorParameter*>& parameters, const StateSettings& settings)
+{
+	juce::MemoryOutputStream out(destination, true);
+
+	out.writeInt(static_cast<int>(magic));
+	out.writeShort(static_cast<short>(currentVersion));
+	out.writeShort(static_cast<short>(parameters.size()));
+	out.writeInt(static_cast<int>(getLayoutHash(parameters)));
+
+	out.writeByte(static_cast<char>(settings.phaseMode));
+	out.writeByte(static_cast<char>(settings.oversamplingFactor));
+	out.writeByte(static_cast<char>(settings.oversamplingFilter));
+	out.writeByte(static_cast<char>((settings.stateVariableFilters ? stateVariableFiltersFlag : 0)
+	                              | (settings.doublePrecisionState ? doublePrecisionStateFlag : 0)));
+	out.writeInt(settings.linearPhaseKernelLength);
+	out.writeInt(settings.linearPhasePartitionSize);
+
+	for (auto* parameter : parameters)
+		out.writeFloat(getPlainValue(*parameter));
+
+	for (auto* parameter : parameters)
+		out.writeString(getParameterID(parameter));
+}
+
+
+bool readBinaryState(const void* data, int sizeInBytes, const juce::Array<juce::AudioProcessorParameter*>& parameters, StateSettings& settings)
+{
+	juce::MemoryInputStream in(data, static_cast<size_t>(juce::jmax(0, sizeInBytes)), false);
+	Header header;
+
+	if (!readHeader(in, sizeInBytes, header, settings))
+		return false;
+
+	// The fast path: the same parameters in the same order
+	if (header.numStored == parameters.size() && header.layoutHash == getLayoutHash(parameters))
+	{
+		for (auto* parameter : parameters)
+			applyValue(*parameter, in.readFloat());
+
+		return true;
+	}
+
+	std::unordered_map<juce::String, juce::AudioProcessorParameter*> parametersByID;
+	for (auto* parameter : parameters)
+		parametersByID.emplace(getParameterID(parameter), parameter);
+
+	forEachStoredValue(in, header, [&parametersByID](const juce::String& id, float value)
+	{
+		const auto it = parametersByID.find(id);
+		if (it != parametersByID.end())
+			applyValue(*it->second, value);
+	});
+
+	return true;
+}
+
+
+juce::ValueTree getBinaryStateParameters(const void* data, int sizeInBytes)
+{
+	juce::MemoryInputStream in(data, static_cast<size_t>(juce::jmax(0, sizeInBytes)), false);
+	Header header;
+	StateSettings settings;
+
+	if (!readHeader(in, sizeInBytes, header, settings))
+		return {};
+
+	juce::ValueTree state("Parameters");
+
+	forEachStoredValue(in, header, [&state](const juce::String& id, float value)
+	{
+		state.appendChild(juce::ValueTree("PARAM", { { "id", id }, { "value", value } }), nullptr);
+	});
+
+	return state;
+}
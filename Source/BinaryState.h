@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    BinaryState.h
+
+    The plugin state as a fixed binary layout: a header, the settings that are
+    not parameters, and every parameter's value in order.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+// What the state holds besides the parameters, as the processor's setters take it
+struct StateSettings
+{
+	int phaseMode = 0;               // 1 for linear
+	int linearPhaseKernelLength = 0;
+	int linearPhasePartitionSize = 0;
+	int oversamplingFactor = 1;
+	int oversamplingFilter = 0;      // 1 for FIR
+	bool stateVariableFilters = false;
+	bool doublePrecisionState = false;
+};
+
+
+/**
+	Little endian, version 1:
+
+		uint32   magic "SEQB"
+		uint16   version
+		uint16   number of parameters
+		uint32   hash of the parameter IDs in order
+		uint8    phase mode, oversampling factor, oversampling filter, flags
+		int32    linear phase kernel length, partition size
+		float32  value of each parameter, in its own range as the state tree holds it
+		string   ID of each parameter, zero terminated UTF-8
+
+	When the hash matches the processor's parameters, the values are applied in order
+	without looking at the IDs. Otherwise, as for a session saved before parameters
+	were added, each stored value goes to the parameter with its ID and the rest keep
+	their values. Later versions may only append to this layout.
+*/
+bool isBinaryState(const void* data, int sizeInBytes);
+
+void writeBinaryState(juce::MemoryBlock& destination, const juce::Array<juce::AudioProcessorParameter*>& parameters, const StateSettings& settings);
+
+// Sets the parameters and fills settings. Returns false, changing nothing, if the data is not a state this version can read.
+bool readBinaryState(const void* data, int sizeInBytes, const juce::Array<juce::AudioProcessorParameter*>& parameters, StateSettings& settings);
+
+// For readers without the parameter objects: the values as the PARAM children (id, value) of a
+// tree shaped like the processor's state, or an invalid tree if the data cannot be read.
+juce::ValueTree getBinaryStateParameters(const void* data, int sizeInBytes);
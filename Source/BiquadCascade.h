@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+
+    Fused biquad cascade kernels. A whole cascade runs in a single pass over
+    the buffer with every section's state held in locals, and the number of
+    sections is a template argument so the inner loop is fully unrolled.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+// Enough for a 96 dB/Oct Butterworth cut (order 16).
+static constexpr int maxCascadeStages = 8;
+
+
+template <typename SampleType>
+struct CascadeTraits
+{
+	using ElementType = SampleType;
+	static SampleType splat(ElementType v) noexcept { return v; }
+	static void snapToZero(SampleType& v) noexcept { juce::dsp::util::snapToZero(v); }
+};
+
+#if JUCE_USE_SIMD
+template <typename ElementType_>
+struct CascadeTraits<juce::dsp::SIMDRegister<ElementType_>>
+{
+	using ElementType = ElementType_;
+	using SampleType = juce::dsp::SIMDRegister<ElementType_>;
+
+	static SampleType splat(ElementType v) noexcept { return SampleType::expand(v); }
+
+	static void snapToZero(SampleType& v) noexcept
+	{
+		for (size_t lane = 0; lane < SampleType::size(); lane++)
+		{
+			auto x = v.get(lane);
+			juce::dsp::util::snapToZero(x);
+			v.set(lane, x);
+		}
+	}
+};
+#endif
+
+
+template <typename SampleType>
+struct BiquadStage
+{
+	SampleType b0, b1, b2, a1, a2;
+};
+
+
+/**
+	Transposed direct form II, with the same operation order and end-of-block
+	snapToZero as juce::dsp::IIR::Filter, so a cascade of N stages produces the
+	same samples as N separate filters run one after another.
+*/
+template <typename SampleType, int NumStages>
+void processBiquadCascade(const BiquadStage<SampleType>* stages, SampleType* state, SampleType* data, size_t numSamples) noexcept
+{
+	if constexpr (NumStages == 0)
+	{
+		juce::ignoreUnused(stages, state, data, numSamples);
+	}
+	else
+	{
+		BiquadStage<SampleType> c[NumStages];
+		SampleType z1[NumStages], z2[NumStages];
+
+		for (int s = 0; s < NumStages; s++)
+		{
+			c[s] = stages[s];
+			z1[s] = state[2 * s];
+			z2[s] = state[2 * s + 1];
+		}
+
+		for (size_t i = 0; i < numSamples; i++)
+		{
+			auto x = data[i];
+
+			for (int s = 0; s < NumStages; s++)
+			{
+				auto y = (x * c[s].b0) + z1[s];
+				z1[s] = (x * c[s].b1) - (y * c[s].a1) + z2[s];
+				z2[s] = (x * c[s].b2) - (y * c[s].a2);
+				x = y;
+			}
+
+			data[i] = x;
+		}
+
+		for (int s = 0; s < NumStages; s++)
+		{
+			CascadeTraits<SampleType>::snapToZero(z1[s]);
+			CascadeTraits<SampleType>::snapToZero(z2[s]);
+			state[2 * s] = z1[s];
+			state[2 * s + 1] = z2[s];
+		}
+	}
+}
+
+
+template <typename SampleType>
+using CascadeKernel = void (*)(const BiquadStage<SampleType>*, SampleType*, SampleType*, size_t) noexcept;
+
+template <typename SampleType, int... StageCounts>
+constexpr std::array<CascadeKernel<SampleType>, sizeof...(StageCounts)> makeCascadeKernelTable(std::integer_sequence<int, StageCounts...>)
+{
+	return { &processBiquadCascade<SampleType, StageCounts>... };
+}
+
+template <typename SampleType>
+CascadeKernel<SampleType> getCascadeKernel(int numStages)
+{
+	static constexpr auto kernels = makeCascadeKernelTable<SampleType>(std::make_integer_sequence<int, maxCascadeStages + 1>());
+
+	jassert(numStages >= 0 && numStages <= maxCascadeStages);
+	return kernels[static_cast<size_t>(numStages)];
+}
+
+
+/**
+	Coefficients, state and the selected kernel for one cascade. The kernel is
+	only looked up again when the number of stages changes.
+*/
+template <typename SampleType, int MaxStages>
+class BiquadCascade
+{
+public:
+	using Traits = CascadeTraits<SampleType>;
+	using ElementType = typename Traits::ElementType;
+
+	BiquadCascade()
+	{
+		for (auto& stage : stages)
+			stage = { Traits::splat(0), Traits::splat(0), Traits::splat(0), Traits::splat(0), Traits::splat(0) };
+
+		reset();
+	}
+
+	// Takes normalised { b0, b1, b2, a1, a2 }, the layout of IIR::Coefficients for a second order section.
+	void setStage(int index, const ElementType* c) noexcept
+	{
+		jassert(index < MaxStages);
+		stages[index] = { Traits::splat(c[0]), Traits::splat(c[1]), Traits::splat(c[2]), Traits::splat(c[3]), Traits::splat(c[4]) };
+	}
+
+	void setNumStages(int newNumStages) noexcept
+	{
+		jassert(newNumStages <= MaxStages);
+
+		if (newNumStages == numStages)
+			return;
+
+		for (int s = numStages; s < newNumStages; s++)
+			state[2 * s] = state[2 * s + 1] = Traits::splat(0);
+
+		numStages = newNumStages;
+		kernel = getCascadeKernel<SampleType>(numStages);
+	}
+
+	int getNumStages() const noexcept { return numStages; }
+
+	void reset() noexcept
+	{
+		state.fill(Traits::splat(0));
+	}
+
+	void process(SampleType* data, size_t numSamples) noexcept
+	{
+		kernel(stages.data(), state.data(), data, numSamples);
+	}
+
+private:
+	std::array<BiquadStage<SampleType>, MaxStages> stages;
+	std::array<SampleType, 2 * MaxStages> state;
+
+	int numStages = 0;
+	CascadeKernel<SampleType> kernel = getCascadeKernel<SampleType>(0);
+};
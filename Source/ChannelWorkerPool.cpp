@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "ChannelWorkerPool.h"
+#include <thread>
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+
+namespace
+{
+	// About a microsecond of spinning before the waiting thread starts to yield its core
+	constexpr int spinsBeforeYielding = 64;
+
+	void pauseWhileSpinning() noexcept
+	{
+	   #if JUCE_INTEL
+		_mm_pause();
+	   #endif
+	}
+}
+
+
+ChannelWorkerPool::Worker::Worker(ChannelWorkerPool& owner, int index)
+	: juce::Thread("Simple_eq channel worker " + juce::String(index)),
+	  pool(owner)
+{
+}
+
+
+void ChannelWorkerPool::Worker::run()
+{
+	while (!threadShouldExit())
+	{
+		if (!wakeUp.wait(100))
+			continue;
+
+		pool.busyWorkers.fetch_add(1, std::memory_order_acq_rel);
+		pool.drainJobs();
+		pool.busyWorkers.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
+
+
+
+ChannelWorkerPool::ChannelWorkerPool(int numWorkers)
+{
+	// Start with nothing to claim
+	nextJob.store(std::numeric_limits<int>::max() / 2);
+
+	for (int i = 0; i < numWorkers; i++)
+		workers.add(new Worker(*this, i))->startThread(juce::Thread::Priority::highest);
+}
+
+
+ChannelWorkerPool::~ChannelWorkerPool()
+{
+	for (auto* worker : workers)
+		worker->signalThreadShouldExit();
+
+	for (auto* worker : workers)
+		worker->wakeUp.signal();
+
+	for (auto* worker : workers)
+		worker->stopThread(1000);
+}
+
+
+void ChannelWorkerPool::run(int numJobs, JobFunction job, void* context) noexcept
+{
+	currentJob.store(job, std::memory_order_relaxed);
+	currentContext.store(context, std::memory_order_relaxed);
+	currentNumJobs.store(numJobs, std::memory_order_relaxed);
+	jobsDone.store(0, std::memory_order_relaxed);
+	nextJob.store(0, std::memory_order_release);
+
+	// The calling thread takes a share too, so one worker fewer than jobs is enough
+	for (int i = 0; i < juce::jmin(numJobs - 1, workers.size()); i++)
+		workers.getUnchecked(i)->wakeUp.signal();
+
+	drainJobs();
+
+	// Jobs are a few microseconds each, so spin rather than sleep
+	for (int spins = 0; jobsDone.load(std::memory_order_acquire) < numJobs
+	                    || busyWorkers.load(std::memory_order_acquire) > 0; spins++)
+	{
+		if (spins < spinsBeforeYielding)
+			pauseWhileSpinning();
+		else
+			std::this_thread::yield();
+	}
+}
+
+
+void ChannelWorkerPool::drainJobs() noexcept
+{
+	for (;;)
+	{
+		const auto index = nextJob.fetch_add(1, std::memory_order_acq_rel);
+		if (index >= currentNumJobs.load(std::memory_order_relaxed))
+			return;
+
+		currentJob.load(std::memory_order_relaxed)(currentContext.load(std::memory_order_relaxed), index);
+		jobsDone.fetch_add(1, std::memory_order_release);
+	}
+}
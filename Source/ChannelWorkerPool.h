@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.h
+
+    A small pool that lets processBlock spread independent channel groups
+    over a few extra cores.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+/**
+	The audio thread hands out job indices through an atomic counter and processes
+	jobs itself until none are left, then spins until the workers have finished theirs:
+	with a pause hint at first, then yielding, so that on a machine with fewer cores
+	than threads the workers it waits for still get to run.
+	Nothing is allocated and no lock is taken by the workers while processing; waking
+	a worker signals its WaitableEvent, which is the only (briefly) blocking call.
+
+	The number of jobs per run() is expected to stay the same between prepareToPlay
+	calls, which is what lets a worker that wakes late join whichever run is current.
+*/
+class ChannelWorkerPool
+{
+public:
+	using JobFunction = void (*)(void* context, int jobIndex);
+
+	explicit ChannelWorkerPool(int numWorkers);
+	~ChannelWorkerPool();
+
+	int getNumWorkers() const { return workers.size(); }
+
+	// Runs job(context, i) for every i in [0, numJobs) and returns once all of them are done.
+	void run(int numJobs, JobFunction job, void* context) noexcept;
+
+private:
+	struct Worker : juce::Thread
+	{
+		Worker(ChannelWorkerPool& owner, int index);
+		void run() override;
+
+		ChannelWorkerPool& pool;
+		juce::WaitableEvent wakeUp;
+	};
+
+	void drainJobs() noexcept;
+
+	juce::OwnedArray<Worker> workers;
+
+	// Written before the release store that resets nextJob, and read after claiming an
+	// index from it, so a worker woken by the previous run never sees them half written
+	std::atomic<JobFunction> currentJob{ nullptr };
+	std::atomic<void*> currentContext{ nullptr };
+	std::atomic<int> currentNumJobs{ 0 };
+
+	std::atomic<int> nextJob{ 0 };
+	std::atomic<int> jobsDone{ 0 };
+	std::atomic<int> busyWorkers{ 0 };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChannelWorkerPool)
+};
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+
+size_t CoefficientCache::KeyHash::operator()(const Key& key) const noexcept
+{
+	auto hash = static_cast<juce::uint64>(key.design) * 0x9e3779b97f4a7c15ull;
+
+	for (auto value : { static_cast<juce::int64>(key.order), key.sampleRate, key.frequency,
+	                    static_cast<juce::int64>(key.q), static_cast<juce::int64>(key.gain) })
+		hash = (hash ^ static_cast<juce::uint64>(value)) * 0x100000001b3ull;
+
+	return static_cast<size_t>(hash);
+}
+
+
+CoefficientCache::Key CoefficientCache::makeKey(Design design, int order, double sampleRate, float frequency, float Q, float gainInDecibels) noexcept
+{
+	return { design,
+	         order,
+	         static_cast<juce::int64>(std::llround(sampleRate * 1000.0)),
+	         static_cast<juce::int64>(std::llround(frequency * 1000.0)),
+	         static_cast<int>(std::lround(Q * 10000.0)),
+	         static_cast<int>(std::lround(gainInDecibels * 1000.0)) };
+}
+
+
+template <typename DesignFunction>
+CoefficientCache::CoefficientSet CoefficientCache::lookUp(const Key& key, DesignFunction&& design)
+{
+	{
+		const juce::ScopedLock sl(lock);
+
+		const auto it = index.find(key);
+		if (it != index.end())
+		{
+			entries.splice(entries.begin(), entries, it->second);
+			++hits;
+			return it->second->coefficients;
+		}
+	}
+
+	++misses;
+	auto coefficients = design();
+
+	const juce::ScopedLock sl(lock);
+
+	// Another instance may have designed the same key meanwhile; keep the one already shared
+	const auto it = index.find(key);
+	if (it != index.end())
+		return it->second->coefficients;
+
+	entries.push_front({ key, coefficients });
+	index.emplace(key, entries.begin());
+
+	while (static_cast<int>(entries.size()) > maxEntries)
+	{
+		index.erase(entries.back().key);
+		entries.pop_back();
+		++evictions;
+	}
+
+	return coefficients;
+}
+
+
+CoefficientCache::CoefficientSet CoefficientCache::getCutFilter(bool isHighPass, float frequency, int order, double sampleRate)
+{
+	auto design = [isHighPass, order, sampleRate](float f)
+	{
+		return isHighPass ? juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(f, sampleRate, order)
+		                  : juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(f, sampleRate, order);
+	};
+
+	if (!isEnabled())
+		return design(frequency);
+
+	const auto key = makeKey(isHighPass ? Design::HighPass : Design::LowPass, order, sampleRate, frequency, 0, 0);
+	return lookUp(key, [&design, &key] { return design(static_cast<float>(key.frequency / 1000.0)); });
+}
+
+
+Coefficients CoefficientCache::getPeakFilter(float frequency, float Q, float gainInDecibels, double sampleRate)
+{
+	auto design = [sampleRate](float f, float q, float gain)
+	{
+		CoefficientSet set;
+		set.add(makePeakFilter(sampleRate, f, q, juce::Decibels::decibelsToGain(gain)));
+		return set;
+	};
+
+	if (!isEnabled())
+		return design(frequency, Q, gainInDecibels).getFirst();
+
+	const auto key = makeKey(Design::Peak, 2, sampleRate, frequency, Q, gainInDecibels);
+	return lookUp(key, [&design, &key]
+	{
+		return design(static_cast<float>(key.frequency / 1000.0), static_cast<float>(key.q / 10000.0), static_cast<float>(key.gain / 1000.0));
+	}).getFirst();
+}
+
+
+CoefficientCache::Stats CoefficientCache::getStats() const
+{
+	const juce::ScopedLock sl(lock);
+	return { hits.load(), misses.load(), evictions.load(), static_cast<int>(entries.size()) };
+}
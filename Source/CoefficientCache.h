@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+
+    Process-wide cache of designed coefficient sets, so instances with the
+    same settings share one design instead of each running their own.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+
+/**
+	A bounded LRU cache keyed on the design type, order, sample rate and the
+	frequency, Q and gain quantised to a grid finer than any parameter's interval.
+	The designs are run from the quantised values, so one key always stands for
+	exactly one set of coefficients.
+
+	Every CoefficientPipeline shares the one instance through a juce::SharedResourcePointer;
+	it lives as long as any of them does. The returned objects are shared
+	with every other instance that asked for the same key and must never be modified.
+
+	Lookups and designs run on the designer thread or in prepareToPlay, never on an audio thread.
+	A miss designs the set outside the lock, so one slow design does not hold up
+	other instances; two instances missing on the same key at once just both design it.
+*/
+class CoefficientCache
+{
+public:
+	using CoefficientSet = juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>;
+
+	static constexpr int maxEntries = 1024;
+
+	// Same designs as makeLoCutFilter / makeHiCutFilter: order / 2 second order sections.
+	CoefficientSet getCutFilter(bool isHighPass, float frequency, int order, double sampleRate);
+
+	// Same design as makePeakFilter.
+	Coefficients getPeakFilter(float frequency, float Q, float gainInDecibels, double sampleRate);
+
+	struct Stats
+	{
+		juce::uint64 hits, misses, evictions;
+		int numEntries;
+	};
+
+	Stats getStats() const;
+
+	// Switches lookups off process-wide, for measuring what the cache saves. Every
+	// request is then designed from the exact values, as it was before the cache.
+	static void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled); }
+	static bool isEnabled() { return enabled.load(); }
+
+private:
+	enum class Design
+	{
+		HighPass,
+		LowPass,
+		Peak
+	};
+
+	struct Key
+	{
+		Design design;
+		int order;
+		juce::int64 sampleRate;    // in mHz
+		juce::int64 frequency;     // in mHz
+		int q;                     // in 1/10000
+		int gain;                  // in 1/1000 dB
+
+		bool operator==(const Key& other) const noexcept
+		{
+			return design == other.design && order == other.order && sampleRate == other.sampleRate
+			    && frequency == other.frequency && q == other.q && gain == other.gain;
+		}
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const noexcept;
+	};
+
+	struct Entry
+	{
+		Key key;
+		CoefficientSet coefficients;
+	};
+
+	static Key makeKey(Design design, int order, double sampleRate, float frequency, float Q, float gainInDecibels) noexcept;
+
+	template <typename DesignFunction>
+	CoefficientSet lookUp(const Key& key, DesignFunction&& design);
+
+	juce::CriticalSection lock;
+	std::list<Entry> entries;   // most recently used first
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+
+	std::atomic<juce::uint64> hits{ 0 }, misses{ 0 }, evictions{ 0 };
+
+	static inline std::atomic<bool> enabled{ true };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientCache)
+};
@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+
+    CoefficientDesign.h
+
+    Allocation-free versions of the designs in FilterChain.h. They write the
+    normalised { b0, b1, b2, a1, a2 } of a second order section straight into
+    existing storage, so they can run on the audio thread while a parameter
+    is being smoothed.
+
+    The trigonometry comes from the polynomial approximations below and the
+    Butterworth section Q values from a table built at compile time, so a
+    96 dB/Oct cascade is redesigned with one tan and no heap traffic at all.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+namespace CoefficientDesignDetail
+{
+	// pi and pi / 2 as a float plus the float closest to the remainder, so that
+	// pi - x and pi / 2 - x stay accurate when x is close to them
+	constexpr float piHi = 3.14159274101257324f, piLo = -8.74227800037248e-08f;
+	constexpr float halfPiHi = 1.57079637050628662f, halfPiLo = -4.37113900018624e-08f;
+
+	// Taylor polynomials, for |x| <= pi / 2
+	inline float sinPolynomial(float x) noexcept
+	{
+		const auto x2 = x * x;
+		return x * (1 + x2 * (-1.f / 6 + x2 * (1.f / 120 + x2 * (-1.f / 5040 + x2 * (1.f / 362880 + x2 * (-1.f / 39916800))))));
+	}
+
+	inline float cosPolynomial(float x) noexcept
+	{
+		const auto x2 = x * x;
+		return 1 + x2 * (-0.5f + x2 * (1.f / 24 + x2 * (-1.f / 720 + x2 * (1.f / 40320 + x2 * (-1.f / 3628800 + x2 * (1.f / 479001600)))))));
+	}
+
+	// For the compile-time tables: the series runs on until it is exact to double precision on [0, pi / 2]
+	constexpr double taylorCos(double x)
+	{
+		double term = 1, sum = 1;
+
+		for (int n = 1; n < 20; n++)
+		{
+			term *= -x * x / ((2 * n - 1) * (2 * n));
+			sum += term;
+		}
+
+		return sum;
+	}
+}
+
+
+// Fast sin and cos for x in [0, pi], within 2.5e-7 of the exact values (the truncation error of the
+// polynomials is below 6e-8, the rest is float rounding). About half the cost of std::sin / std::cos.
+inline float fastSin(float x) noexcept
+{
+	using namespace CoefficientDesignDetail;
+	return sinPolynomial(x > halfPiHi ? (piHi - x) + piLo : x);
+}
+
+inline float fastCos(float x) noexcept
+{
+	using namespace CoefficientDesignDetail;
+	return x > halfPiHi ? -cosPolynomial((piHi - x) + piLo) : cosPolynomial(x);
+}
+
+// Fast tan for x in [0, pi / 2), within 3e-7 relative error: above pi / 4 it is worked out
+// as cot(pi / 2 - x), so it stays accurate all the way up to the pole.
+inline float fastTan(float x) noexcept
+{
+	using namespace CoefficientDesignDetail;
+
+	if (x <= 0.5f * halfPiHi)
+		return sinPolynomial(x) / cosPolynomial(x);
+
+	const auto y = (halfPiHi - x) + halfPiLo;
+	return cosPolynomial(y) / sinPolynomial(y);
+}
+
+
+constexpr int maxButterworthSections = 8;
+
+// 1 / Q = 2 cos((2 i + 1) pi / (2 order)) for section i of an even order Butterworth cascade, as
+// FilterDesign uses them, indexed [order / 2 - 1][i]. Worked out by the compiler.
+constexpr auto butterworthSectionDampings = []
+{
+	std::array<std::array<float, maxButterworthSections>, maxButterworthSections> table{};
+
+	for (int numSections = 1; numSections <= maxButterworthSections; numSections++)
+		for (int i = 0; i < numSections; i++)
+			table[static_cast<size_t>(numSections - 1)][static_cast<size_t>(i)]
+				= static_cast<float>(2 * CoefficientDesignDetail::taylorCos((2 * i + 1) * juce::MathConstants<double>::pi / (4 * numSections)));
+
+	return table;
+}();
+
+
+// Same formulas as juce::dsp::IIR::Coefficients<float>::makePeakFilter.
+inline void designPeakSection(float* c, double sampleRate, float frequency, float Q, float gainFactor) noexcept
+{
+	const auto A = juce::jmax(0.f, std::sqrt(gainFactor));
+	const auto omega = (2 * juce::MathConstants<float>::pi * juce::jmax(frequency, 2.f)) / static_cast<float>(sampleRate);
+
+	// Only a peak above Nyquist, at a very low processing rate, leaves the fast range
+	const auto inRange = omega <= juce::MathConstants<float>::pi;
+	const auto alpha = (inRange ? fastSin(omega) : std::sin(omega)) / (Q * 2);
+	const auto c2 = -2 * (inRange ? fastCos(omega) : std::cos(omega));
+	const auto alphaTimesA = alpha * A;
+	const auto alphaOverA = alpha / A;
+
+	const auto a0 = 1 + alphaOverA;
+
+	c[0] = (1 + alphaTimesA) / a0;
+	c[1] = c2 / a0;
+	c[2] = (1 - alphaTimesA) / a0;
+	c[3] = c2 / a0;
+	c[4] = (1 - alphaOverA) / a0;
+}
+
+
+// 1 / Q of section `index` of an even order Butterworth cascade, as used by FilterDesign.
+inline float getButterworthSectionDamping(int order, int index) noexcept
+{
+	jassert(order % 2 == 0 && order / 2 <= maxButterworthSections && index < order / 2);
+	return butterworthSectionDampings[static_cast<size_t>(order / 2 - 1)][static_cast<size_t>(index)];
+}
+
+inline float getButterworthSectionQ(int order, int index) noexcept
+{
+	return 1 / getButterworthSectionDamping(order, index);
+}
+
+
+// tan(pi f / fs), the prewarped cutoff of the bilinear transform
+inline float getPrewarpedCutoff(double sampleRate, float frequency) noexcept
+{
+	const auto x = juce::MathConstants<float>::pi * frequency / static_cast<float>(sampleRate);
+	return x < CoefficientDesignDetail::halfPiHi ? fastTan(x) : std::tan(x);
+}
+
+
+// The section of IIR::Coefficients<float>::makeHighPass / makeLowPass with prewarped cutoff t and 1 / Q.
+inline void designCutSection(float* c, bool isHighPass, float t, float invQ) noexcept
+{
+	const auto n = isHighPass ? t : 1 / t;
+	const auto nSquared = n * n;
+	const auto c1 = 1 / (1 + invQ * n + nSquared);
+
+	c[0] = c1;
+	c[1] = isHighPass ? c1 * -2 : c1 * 2;
+	c[2] = c1;
+	c[3] = isHighPass ? c1 * 2 * (nSquared - 1) : c1 * 2 * (1 - nSquared);
+	c[4] = c1 * (1 - invQ * n + nSquared);
+}
+
+
+// Same formulas as IIR::Coefficients<float>::makeHighPass / makeLowPass.
+inline void designCutSection(float* c, bool isHighPass, double sampleRate, float frequency, float Q) noexcept
+{
+	designCutSection(c, isHighPass, getPrewarpedCutoff(sampleRate, frequency), 1 / Q);
+}
+
+
+// Same sections as FilterDesign's designIIRHighpassHighOrderButterworthMethod / ...Lowpass...
+// for an even order, written to getSection(0) ... getSection(order / 2 - 1). The cutoff is
+// shared by every section, so the whole cascade costs one tan.
+template <typename SectionFunction>
+void designCutFilter(SectionFunction&& getSection, bool isHighPass, double sampleRate, float frequency, int order) noexcept
+{
+	const auto t = getPrewarpedCutoff(sampleRate, frequency);
+
+	for (int i = 0; i < order / 2; i++)
+		designCutSection(getSection(i), isHighPass, t, getButterworthSectionDamping(order, i));
+}
+
+
+// Same formulas as IIR::Coefficients<float>::makeLowShelf / makeHighShelf.
+inline void designShelfSection(float* c, bool isHighShelf, double sampleRate, float frequency, float Q, float gainFactor) noexcept
+{
+	const auto A = juce::jmax(0.f, std::sqrt(gainFactor));
+	const auto aminus1 = A - 1;
+	const auto aplus1 = A + 1;
+	const auto omega = (2 * juce::MathConstants<float>::pi * juce::jmax(frequency, 2.f)) / static_cast<float>(sampleRate);
+	const auto coso = std::cos(omega);
+	const auto beta = std::sin(omega) * std::sqrt(A) / Q;
+	const auto aminus1TimesCoso = aminus1 * coso;
+
+	if (isHighShelf)
+	{
+		const auto a0 = aplus1 - aminus1TimesCoso + beta;
+
+		c[0] = A * (aplus1 + aminus1TimesCoso + beta) / a0;
+		c[1] = A * -2 * (aminus1 + aplus1 * coso) / a0;
+		c[2] = A * (aplus1 + aminus1TimesCoso - beta) / a0;
+		c[3] = 2 * (aminus1 - aplus1 * coso) / a0;
+		c[4] = (aplus1 - aminus1TimesCoso - beta) / a0;
+	}
+	else
+	{
+		const auto a0 = aplus1 + aminus1TimesCoso + beta;
+
+		c[0] = A * (aplus1 - aminus1TimesCoso + beta) / a0;
+		c[1] = A * 2 * (aminus1 - aplus1 * coso) / a0;
+		c[2] = A * (aplus1 - aminus1TimesCoso - beta) / a0;
+		c[3] = -2 * (aminus1 + aplus1 * coso) / a0;
+		c[4] = (aplus1 + aminus1TimesCoso - beta) / a0;
+	}
+}
+
+
+// Same formulas as IIR::Coefficients<float>::makeNotch.
+inline void designNotchSection(float* c, double sampleRate, float frequency, float Q) noexcept
+{
+	const auto n = 1 / std::tan(juce::MathConstants<float>::pi * frequency / static_cast<float>(sampleRate));
+	const auto nSquared = n * n;
+	const auto c1 = 1 / (1 + n / Q + nSquared);
+
+	c[0] = c1 * (1 + nSquared);
+	c[1] = 2 * c1 * (1 - nSquared);
+	c[2] = c1 * (1 + nSquared);
+	c[3] = c1 * 2 * (1 - nSquared);
+	c[4] = c1 * (1 - n / Q + nSquared);
+}
+
+
+// True for a section that passes its input unchanged: b0 = 1 and the zeros sit on the poles,
+// which is what the designs in this file produce for a peak or shelf at 0 dB, as they divide
+// each term by a0 (IIR::Coefficients multiplies by 1 / a0 instead, and its b0 can round to
+// an ulp below 1). Such a section can be skipped outright. The comparison is exact on purpose:
+// for any other gain the terms differ by a multiple of alpha = sin(omega) / 2Q, which at a low
+// frequency, high Q and high rate is far below any fixed tolerance although the peak is real.
+inline bool isIdentitySection(const float* c) noexcept
+{
+	return c[0] == 1 && c[1] == c[3] && c[2] == c[4];
+}
+
+
+// Samples until the impulse response of a stable section has decayed by decayInDecibels,
+// from the radius of its poles, the roots of z^2 + a1 z + a2.
+inline double getSectionDecaySamples(const float* c, double decayInDecibels = 120.0) noexcept
+{
+	const double a1 = c[3], a2 = c[4];
+	const auto discriminant = a1 * a1 - 4 * a2;
+
+	const auto radius = discriminant < 0 ? std::sqrt(a2)
+	                                     : (std::abs(a1) + std::sqrt(discriminant)) / 2;
+
+	if (radius < 1.0e-6)
+		return 2;
+
+	jassert(radius < 1);
+	return 2 + std::log(juce::Decibels::decibelsToGain(-decayInDecibels)) / std::log(juce::jmin(radius, 1 - 1.0e-12));
+}
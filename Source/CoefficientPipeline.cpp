@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+    CoefficientPipeline.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientPipeline.h"
+#include "CoefficientDesign.h"
+
+
+CoefficientDesigner::CoefficientDesigner()
+	: juce::Thread("Simple_eq coefficient designer")
+{
+	startThread();
+}
+
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+	stopThread(1000);
+}
+
+
+void CoefficientDesigner::add(CoefficientPipeline& pipeline)
+{
+	{
+		const juce::ScopedLock sl(lock);
+		pipelines.addIfNotAlreadyThere(&pipeline);
+	}
+
+	// For whatever changed while it was not being served
+	notify();
+}
+
+
+void CoefficientDesigner::remove(CoefficientPipeline& pipeline)
+{
+	const juce::ScopedLock sl(lock);
+	pipelines.removeFirstMatchingValue(&pipeline);
+}
+
+
+void CoefficientDesigner::run()
+{
+	while (!threadShouldExit())
+	{
+		bool anyRetired = false;
+
+		{
+			const juce::ScopedLock sl(lock);
+
+			for (auto* pipeline : pipelines)
+				anyRetired = pipeline->serve() || anyRetired;
+		}
+
+		// A notify() that comes in while serving leaves the event set, so it is not lost
+		wait(anyRetired ? retiredCheckIntervalMs : -1);
+	}
+}
+
+
+CoefficientPipeline::CoefficientPipeline(juce::AudioProcessorValueTreeState& state, BandParameters& bands, PerformanceProbe* probe)
+	: apvts(state),
+	  snapshot(state),
+	  bandParameters(bands),
+	  performanceProbe(probe)
+{
+	for (auto* parameter : apvts.processor.getParameters())
+		if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+			apvts.addParameterListener(withID->paramID, this);
+}
+
+
+CoefficientPipeline::~CoefficientPipeline()
+{
+	release();
+
+	for (auto* parameter : apvts.processor.getParameters())
+		if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+			apvts.removeParameterListener(withID->paramID, this);
+}
+
+
+void CoefficientPipeline::prepare(double newSampleRate)
+{
+	release();
+
+	sampleRate = newSampleRate;
+	snapshot.invalidate();
+	changesPending = false;
+
+	bandParameters.takeChangedBands(BandParameters::Designer);
+	designBands(BandParameters::allBands);
+	designChangedSections();
+	updateTail();
+	publish();
+
+	designer->add(*this);
+}
+
+
+void CoefficientPipeline::release()
+{
+	designer->remove(*this);
+}
+
+
+// Every parameter is listened to, so a change that does not affect any design costs one refresh
+void CoefficientPipeline::parameterChanged(const juce::String&, float)
+{
+	if (!changesPending.exchange(true))
+		designer->wake();
+}
+
+
+const ChainCoefficients* CoefficientPipeline::pull()
+{
+	if ((middleSlot.load(std::memory_order_acquire) & newDataFlag) == 0)
+		return nullptr;
+
+	frontSlot = middleSlot.exchange(frontSlot, std::memory_order_acq_rel) & slotMask;
+	return &slots[frontSlot];
+}
+
+
+void CoefficientPipeline::publish()
+{
+	slots[backSlot] = latest;
+	backSlot = middleSlot.exchange(backSlot | newDataFlag, std::memory_order_acq_rel) & slotMask;
+}
+
+
+bool CoefficientPipeline::serve()
+{
+	// Cleared before the values are read, so a change made meanwhile wakes the designer again
+	if (changesPending.exchange(false))
+	{
+		const auto profiling = performanceProbe != nullptr && performanceProbe->isEnabled();
+		const auto startTicks = profiling ? PerformanceProbe::now() : 0;
+
+		if (designChangedSections())
+		{
+			updateTail();
+			publish();
+
+			if (profiling)
+				performanceProbe->record(PerformanceProbe::Designer, PerformanceProbe::now() - startTicks, 0);
+		}
+	}
+
+	releaseRetiredCoefficients();
+
+	return !retired.empty();
+}
+
+
+bool CoefficientPipeline::designChangedSections()
+{
+	snapshot.refresh();
+
+	bool anyChanged = false;
+
+	for (auto section : { ChainPositions::LoCut, ChainPositions::Peak, ChainPositions::HiCut })
+	{
+		if (latest.generations[section] == snapshot.getGeneration(section))
+		{
+			++numSkippedRedesigns;
+			continue;
+		}
+
+		designSection(section);
+		latest.generations[section] = snapshot.getGeneration(section);
+
+		++numRedesigns;
+		anyChanged = true;
+	}
+
+	// Only the bands whose parameters moved, however many bands there are
+	if (const auto changedBands = bandParameters.takeChangedBands(BandParameters::Designer))
+	{
+		designBands(changedBands);
+
+		++numRedesigns;
+		anyChanged = true;
+	}
+
+	return anyChanged;
+}
+
+
+void CoefficientPipeline::designBands(juce::uint32 bandsToDesign)
+{
+	for (int band = 0; band < maxParametricBands; band++)
+	{
+		const auto bit = 1u << band;
+		if ((bandsToDesign & bit) == 0)
+			continue;
+
+		const auto settings = bandParameters.getSettings(band);
+		designBand(latest.bands[static_cast<size_t>(band)].data(), settings, sampleRate);
+
+		latest.enabledBands = settings.enabled ? (latest.enabledBands | bit) : (latest.enabledBands & ~bit);
+	}
+
+	++latest.bandsGeneration;
+}
+
+
+void CoefficientPipeline::designSection(ChainPositions section)
+{
+	const auto& chainSettings = snapshot.getSettings();
+
+	switch (section)
+	{
+	case ChainPositions::LoCut:
+	{
+		auto loCutCoefficients = designCache->getCutFilter(true, chainSettings.loCutFreq, getCutFilterOrder(chainSettings.loCutSlope), sampleRate);
+		for (int i = 0; i < loCutCoefficients.size(); i++)
+		{
+			retire(latest.loCut[i]);
+			latest.loCut[i] = loCutCoefficients[i];
+		}
+		latest.loCutSlope = chainSettings.loCutSlope;
+		break;
+	}
+	case ChainPositions::Peak:
+		retire(latest.peak);
+		latest.peak = designCache->getPeakFilter(chainSettings.peakFreq, chainSettings.peakQ, chainSettings.peakGain, sampleRate);
+		break;
+	case ChainPositions::HiCut:
+	{
+		auto hiCutCoefficients = designCache->getCutFilter(false, chainSettings.hiCutFreq, getCutFilterOrder(chainSettings.hiCutSlope), sampleRate);
+		for (int i = 0; i < hiCutCoefficients.size(); i++)
+		{
+			retire(latest.hiCut[i]);
+			latest.hiCut[i] = hiCutCoefficients[i];
+		}
+		latest.hiCutSlope = chainSettings.hiCutSlope;
+		break;
+	}
+	}
+}
+
+
+// The impulse response of a cascade is the convolution of its sections, so it
+// is no longer than the sum of their lengths. Transparent sections add nothing.
+void CoefficientPipeline::updateTail()
+{
+	double tail = 0;
+
+	auto addSection = [&tail](const float* c)
+	{
+		if (!isIdentitySection(c))
+			tail += getSectionDecaySamples(c);
+	};
+
+	addSection(latest.peak->getRawCoefficients());
+
+	for (int i = 0; i < getCutFilterNumStages(latest.loCutSlope); i++)
+		addSection(latest.loCut[i]->getRawCoefficients());
+
+	for (int i = 0; i < getCutFilterNumStages(latest.hiCutSlope); i++)
+		addSection(latest.hiCut[i]->getRawCoefficients());
+
+	for (int band = 0; band < maxParametricBands; band++)
+		if ((latest.enabledBands & (1u << band)) != 0)
+			addSection(latest.bands[static_cast<size_t>(band)].data());
+
+	latest.tailSamples = tail;
+}
+
+
+// A cached object can come back into use and be retired again; it is only listed once,
+// or its own duplicates would keep the reference count above one for good.
+void CoefficientPipeline::retire(Coefficients& coefficients)
+{
+	if (coefficients != nullptr && std::find(retired.begin(), retired.end(), coefficients) == retired.end())
+		retired.push_back(coefficients);
+}
+
+
+// Anything only referenced from here is no longer held by a slot or a filter.
+void CoefficientPipeline::releaseRetiredCoefficients()
+{
+	retired.erase(std::remove_if(retired.begin(), retired.end(),
+	                             [](const Coefficients& c) { return c->getReferenceCount() == 1; }),
+	              retired.end());
+}
@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    CoefficientPipeline.h
+
+    Designs the filter coefficients on a background thread and hands them to
+    the audio thread through a wait-free triple buffer. One designer thread
+    serves every instance in the process.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+#include "ParameterSnapshot.h"
+#include "ParametricBands.h"
+#include "CoefficientCache.h"
+#include "PerformanceProbe.h"
+
+
+struct ChainCoefficients
+{
+	Coefficients peak;
+	CutFilter::CoefficientArray loCut, hiCut;
+	int loCutSlope{ Slope::Slope_12 }, hiCutSlope{ Slope::Slope_12 };
+
+	// Which ParameterSnapshot generation each section was designed from.
+	std::array<juce::uint32, 3> generations{};
+
+	// The parametric bands, as plain values since they are only ever copied.
+	BandCoefficientArray bands{};
+	juce::uint32 enabledBands = 0;
+	juce::uint32 bandsGeneration = 0;    // bumped whenever any band is redesigned
+
+	// Until the impulse response of the whole chain has decayed by 120 dB, at the design rate
+	double tailSamples = 0;
+};
+
+
+class CoefficientPipeline;
+
+
+/**
+	The one thread that designs for every CoefficientPipeline in the process, held
+	through a juce::SharedResourcePointer. It sleeps until a pipeline's parameters
+	change, so idle instances cost no wakeups at all; only while some pipeline still
+	holds retired coefficients does it also look again every retiredCheckIntervalMs.
+*/
+class CoefficientDesigner  : private juce::Thread
+{
+public:
+	CoefficientDesigner();
+	~CoefficientDesigner() override;
+
+	// Message thread. remove() returns once the pipeline is no longer being served.
+	void add(CoefficientPipeline& pipeline);
+	void remove(CoefficientPipeline& pipeline);
+
+	// Any thread, including the audio thread
+	void wake() { notify(); }
+
+private:
+	void run() override;
+
+	static constexpr int retiredCheckIntervalMs = 500;
+
+	juce::CriticalSection lock;    // held while the pipelines are served
+	juce::Array<CoefficientPipeline*> pipelines;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientDesigner)
+};
+
+
+/**
+	Owns three ChainCoefficients slots. The designer thread always writes into the
+	back slot and publishes it by swapping it with the middle slot; the audio thread
+	swaps the middle slot with its front slot when a new set is flagged. Neither side
+	ever waits for the other.
+
+	Published coefficient objects are never modified. A section that did not change
+	keeps pointing at the same objects from one slot to the next, and objects that
+	drop out of use are only released here, once the designer holds the last reference,
+	so the audio thread never frees anything either. The LoCut, Peak and HiCut designs
+	come from the process-wide CoefficientCache, whose references keep a cached object
+	alive until it is evicted, which again happens on a designer thread.
+*/
+class CoefficientPipeline  : private juce::AudioProcessorValueTreeState::Listener
+{
+public:
+	// The probe, if any, times each round of redesigns; it has to outlive the pipeline.
+	CoefficientPipeline(juce::AudioProcessorValueTreeState& apvts, BandParameters& bandParameters, PerformanceProbe* probe = nullptr);
+	~CoefficientPipeline() override;
+
+	// Designs the first set synchronously and hands the pipeline to the designer thread.
+	void prepare(double sampleRate);
+	void release();
+
+	// Audio thread only. Returns the newest set if one was published since the last call, nullptr otherwise.
+	const ChainCoefficients* pull();
+
+	juce::uint64 getNumRedesigns() const { return numRedesigns.load(); }
+	juce::uint64 getNumSkippedRedesigns() const { return numSkippedRedesigns.load(); }
+
+	// Process-wide, shared by every instance
+	CoefficientCache::Stats getCacheStats() const { return designCache->getStats(); }
+
+private:
+	friend class CoefficientDesigner;
+
+	// Called by the APVTS after it has stored the new value, so the designer never reads an older one
+	void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+	// Designer thread. Returns true while retired coefficients are still waiting to be released.
+	bool serve();
+
+	bool designChangedSections();
+	void designSection(ChainPositions section);
+	void designBands(juce::uint32 bandsToDesign);
+	void updateTail();
+	void retire(Coefficients& coefficients);
+	void releaseRetiredCoefficients();
+	void publish();
+
+	juce::AudioProcessorValueTreeState& apvts;
+	ParameterSnapshot snapshot;
+	BandParameters& bandParameters;
+	juce::SharedResourcePointer<CoefficientCache> designCache;
+	juce::SharedResourcePointer<CoefficientDesigner> designer;
+	std::atomic<bool> changesPending{ false };
+	PerformanceProbe* performanceProbe;
+
+	ChainCoefficients latest;                 // designer thread
+	std::vector<Coefficients> retired;        // designer thread
+
+	std::array<ChainCoefficients, 3> slots;
+
+	static constexpr int slotMask = 3;
+	static constexpr int newDataFlag = 4;
+
+	std::atomic<int> middleSlot{ 1 };
+	int backSlot = 2;     // designer thread
+	int frontSlot = 0;    // audio thread
+
+	std::atomic<juce::uint64> numRedesigns{ 0 }, numSkippedRedesigns{ 0 };
+	double sampleRate = 0;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientPipeline)
+};
@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.cpp
+
+  ==============================================================================
+*/
+
+#include "DynamicPeak.h"
+#include "CoefficientDesign.h"
+
+
+void addDynamicPeakParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+	layout.add(std::make_unique<juce::AudioParameterBool>("Peak Dynamic", "Peak Dynamic", false));
+	layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Threshold",
+	                                                       "Peak Threshold",
+	                                                       juce::NormalisableRange<float>(-60.f, 0.f, 0.5f, 1.f),
+	                                                       -24.f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Range",
+	                                                       "Peak Range",
+	                                                       juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+	                                                       -6.f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Attack",
+	                                                       "Peak Attack",
+	                                                       juce::NormalisableRange<float>(0.1f, 100.f, 0.1f, 0.4f),
+	                                                       5.f));
+	layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Release",
+	                                                       "Peak Release",
+	                                                       juce::NormalisableRange<float>(5.f, 2000.f, 1.f, 0.4f),
+	                                                       150.f));
+	layout.add(std::make_unique<juce::AudioParameterBool>("Peak Sidechain", "Peak Sidechain", false));
+}
+
+
+DynamicPeak::DynamicPeak(juce::AudioProcessorValueTreeState& apvts)
+	: enabledParameter  (apvts.getRawParameterValue("Peak Dynamic")),
+	  thresholdParameter(apvts.getRawParameterValue("Peak Threshold")),
+	  rangeParameter    (apvts.getRawParameterValue("Peak Range")),
+	  attackParameter   (apvts.getRawParameterValue("Peak Attack")),
+	  releaseParameter  (apvts.getRawParameterValue("Peak Release")),
+	  sidechainParameter(apvts.getRawParameterValue("Peak Sidechain"))
+{
+	jassert(enabledParameter != nullptr && thresholdParameter != nullptr && rangeParameter != nullptr
+		 && attackParameter != nullptr && releaseParameter != nullptr && sidechainParameter != nullptr);
+
+	for (int i = 0; i < tableSize; i++)
+	{
+		const auto A = std::pow(10.0, (i * tableStep - tableRange) / 40.0);
+		gainTable[static_cast<size_t>(i)] = static_cast<float>(A);
+		inverseGainTable[static_cast<size_t>(i)] = static_cast<float>(1 / A);
+	}
+}
+
+
+void DynamicPeak::prepare(double newHostSampleRate, double newProcessingSampleRate, int maximumBlockSize)
+{
+	hostSampleRate = newHostSampleRate;
+	processingSampleRate = newProcessingSampleRate;
+
+	envelope.assign(static_cast<size_t>(juce::jmax(1, maximumBlockSize)), 0.f);
+
+	// Everything that depends on the rates is worked out again on first use
+	attackMs = releaseMs = -1;
+	detectorFrequency = detectorQ = -1;
+	designedFrequency = designedQ = -1;
+
+	reset();
+}
+
+
+void DynamicPeak::reset() noexcept
+{
+	ic1 = ic2 = 0;
+	envelopeLevel = 0;
+	numAnalysed = 0;
+}
+
+
+bool DynamicPeak::update() noexcept
+{
+	threshold = thresholdParameter->load();
+	range = rangeParameter->load();
+	sidechain = sidechainParameter->load() >= 0.5f;
+
+	const auto wasActive = active;
+	active = enabledParameter->load() >= 0.5f && range != 0;
+
+	// Coming back on, the envelope starts from silence rather than from wherever it stopped
+	if (active && !wasActive)
+		reset();
+
+	const auto attack = attackParameter->load();
+	const auto release = releaseParameter->load();
+
+	if (attack != attackMs || release != releaseMs)
+	{
+		attackMs = attack;
+		releaseMs = release;
+		attackCoefficient = static_cast<float>(std::exp(-1.0 / (0.001 * attackMs * hostSampleRate)));
+		releaseCoefficient = static_cast<float>(std::exp(-1.0 / (0.001 * releaseMs * hostSampleRate)));
+	}
+
+	return active;
+}
+
+
+template <typename SampleType>
+void DynamicPeak::analyse(const juce::dsp::AudioBlock<const SampleType>& detector, const ChainSettings& settings) noexcept
+{
+	if (settings.peakFreq != detectorFrequency || settings.peakQ != detectorQ)
+	{
+		detectorFrequency = settings.peakFreq;
+		detectorQ = settings.peakQ;
+
+		const auto g = getPrewarpedCutoff(hostSampleRate, juce::jlimit(2.f, static_cast<float>(hostSampleRate * 0.49), detectorFrequency));
+
+		bandK = 1 / detectorQ;
+		bandA1 = 1 / (1 + g * (g + bandK));
+		bandA2 = g * bandA1;
+		bandA3 = g * bandA2;
+	}
+
+	const auto numChannels = detector.getNumChannels();
+	numAnalysed = juce::jmin(static_cast<int>(detector.getNumSamples()), static_cast<int>(envelope.size()));
+
+	if (numChannels == 0)
+	{
+		std::fill_n(envelope.begin(), numAnalysed, 0.f);
+		return;
+	}
+
+	const auto channelGain = 1.f / static_cast<float>(numChannels);
+
+	for (int i = 0; i < numAnalysed; i++)
+	{
+		float x = 0;
+		for (size_t ch = 0; ch < numChannels; ch++)
+			x += static_cast<float>(detector.getSample(static_cast<int>(ch), i));
+		x *= channelGain;
+
+		// Band-pass output, normalised to unity gain at the centre
+		const auto v3 = x - ic2;
+		const auto v1 = bandA1 * ic1 + bandA2 * v3;
+		const auto v2 = ic2 + bandA2 * ic1 + bandA3 * v3;
+		ic1 = 2 * v1 - ic1;
+		ic2 = 2 * v2 - ic2;
+
+		const auto level = std::abs(bandK * v1);
+		const auto coefficient = level > envelopeLevel ? attackCoefficient : releaseCoefficient;
+		envelopeLevel = level + coefficient * (envelopeLevel - level);
+
+		envelope[static_cast<size_t>(i)] = envelopeLevel;
+	}
+
+	JUCE_SNAP_TO_ZERO(ic1);
+	JUCE_SNAP_TO_ZERO(ic2);
+}
+
+template void DynamicPeak::analyse<float>(const juce::dsp::AudioBlock<const float>&, const ChainSettings&) noexcept;
+template void DynamicPeak::analyse<double>(const juce::dsp::AudioBlock<const double>&, const ChainSettings&) noexcept;
+
+
+float DynamicPeak::getGainOffset(int sample) const noexcept
+{
+	if (numAnalysed == 0)
+		return 0;
+
+	const auto level = juce::Decibels::gainToDecibels(envelope[static_cast<size_t>(juce::jlimit(0, numAnalysed - 1, sample))]);
+	return range * juce::jlimit(0.f, 1.f, (level - threshold) / rangeSpanDecibels);
+}
+
+
+void DynamicPeak::designSection(float* c, float frequency, float Q, float gainInDecibels) noexcept
+{
+	if (frequency != designedFrequency || Q != designedQ)
+	{
+		designedFrequency = frequency;
+		designedQ = Q;
+
+		const auto omega = (2 * juce::MathConstants<float>::pi * juce::jmax(frequency, 2.f)) / static_cast<float>(processingSampleRate);
+		const auto inRange = omega <= juce::MathConstants<float>::pi;
+
+		alpha = (inRange ? fastSin(omega) : std::sin(omega)) / (Q * 2);
+		c2 = -2 * (inRange ? fastCos(omega) : std::cos(omega));
+	}
+
+	// Linear interpolation between the table's points is well under 0.01 dB off
+	const auto position = (juce::jlimit(-tableRange, tableRange, gainInDecibels) + tableRange) / tableStep;
+	const auto index = juce::jmin(static_cast<int>(position), tableSize - 2);
+	const auto fraction = position - static_cast<float>(index);
+
+	const auto A = juce::jmap(fraction, gainTable[static_cast<size_t>(index)], gainTable[static_cast<size_t>(index + 1)]);
+	const auto inverseA = juce::jmap(fraction, inverseGainTable[static_cast<size_t>(index)], inverseGainTable[static_cast<size_t>(index + 1)]);
+
+	const auto alphaTimesA = alpha * A;
+	const auto alphaOverA = alpha * inverseA;
+	const auto inverseA0 = 1 / (1 + alphaOverA);
+
+	c[0] = (1 + alphaTimesA) * inverseA0;
+	c[1] = c2 * inverseA0;
+	c[2] = (1 - alphaTimesA) * inverseA0;
+	c[3] = c2 * inverseA0;
+	c[4] = (1 - alphaOverA) * inverseA0;
+}
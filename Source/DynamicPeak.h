@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.h
+
+    Dynamic EQ for the Peak band: an envelope follower on the input, or on
+    the sidechain bus, pushes Peak Gain away from its static value once the
+    level in the band crosses a threshold.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+
+// Adds the dynamic parameters of the Peak band to the layout.
+void addDynamicPeakParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+
+
+/**
+	The detector band-passes the mean of the detector channels at the peak's own
+	frequency and Q, so only energy in the band drives the gain, and follows it with
+	a peak envelope. Above the threshold the gain moves towards Peak Gain + Range,
+	reaching it rangeSpanDecibels above the threshold.
+
+	The envelope is kept per host sample for the block; getGainOffset() reads it at
+	whatever position the filter chain has reached, so it works at any oversampling
+	factor.
+
+	designSection() is the cheap coefficient update the filter chain calls every
+	updateInterval samples while the gain moves. designPeakSection() costs a sin, a cos,
+	a sqrt and two divisions per call; here the frequency and Q terms are kept until
+	they change and the gain factor comes from a table, which leaves one division.
+*/
+class DynamicPeak
+{
+public:
+	// Processing-rate samples between two coefficient updates while the gain moves
+	static constexpr int updateInterval = 16;
+
+	explicit DynamicPeak(juce::AudioProcessorValueTreeState& apvts);
+
+	// Not real-time safe. The envelope runs at the host rate, the sections are designed at the processing rate.
+	void prepare(double hostSampleRate, double processingSampleRate, int maximumBlockSize);
+	void reset() noexcept;
+
+	// Audio thread, once per block. Reloads the parameters; returns whether the dynamics are in use.
+	bool update() noexcept;
+
+	bool isActive() const noexcept { return active; }
+	bool wantsSidechain() const noexcept { return sidechain; }
+
+	// Audio thread. Follows the detector channels for the block, with the band at settings' peak.
+	template <typename SampleType>
+	void analyse(const juce::dsp::AudioBlock<const SampleType>& detector, const ChainSettings& settings) noexcept;
+
+	// dB to add to Peak Gain at a host-rate sample of the block analysed last
+	float getGainOffset(int sample) const noexcept;
+
+	// Same result as designPeakSection(c, processingSampleRate, frequency, Q, gainFactor)
+	void designSection(float* c, float frequency, float Q, float gainInDecibels) noexcept;
+
+private:
+	std::atomic<float>* enabledParameter;
+	std::atomic<float>* thresholdParameter;
+	std::atomic<float>* rangeParameter;
+	std::atomic<float>* attackParameter;
+	std::atomic<float>* releaseParameter;
+	std::atomic<float>* sidechainParameter;
+
+	static constexpr float rangeSpanDecibels = 12.f;
+
+	double hostSampleRate = 44100, processingSampleRate = 44100;
+
+	bool active = false, sidechain = false;
+	float threshold = 0, range = 0;
+	float attackMs = -1, releaseMs = -1;
+	float attackCoefficient = 0, releaseCoefficient = 0;
+
+	// Detector band-pass, a TPT state variable filter
+	float detectorFrequency = -1, detectorQ = -1;
+	float bandA1 = 0, bandA2 = 0, bandA3 = 0, bandK = 0;
+	float ic1 = 0, ic2 = 0;
+	float envelopeLevel = 0;
+
+	std::vector<float> envelope;   // per host sample of the last block
+	int numAnalysed = 0;
+
+	// Peak terms that only depend on frequency and Q
+	float designedFrequency = -1, designedQ = -1;
+	float alpha = 0, c2 = 0;
+
+	// A = 10^(dB / 40) and 1 / A in tableStep dB steps over +-tableRange dB
+	static constexpr float tableRange = 48.f, tableStep = 0.25f;
+	static constexpr int tableSize = static_cast<int>(2 * tableRange / tableStep) + 1;
+	std::array<float, tableSize> gainTable{}, inverseGainTable{};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DynamicPeak)
+};
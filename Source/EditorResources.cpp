@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    EditorResources.cpp
+
+  ==============================================================================
+*/
+
+#include "EditorResources.h"
+
+
+juce::Font EditorResources::getFont(float height)
+{
+	const auto key = juce::roundToInt(height * 100);
+
+	const auto it = fonts.find(key);
+	if (it != fonts.end())
+		return it->second;
+
+	return fonts.emplace(key, juce::Font(height)).first->second;
+}
+
+
+juce::Image EditorResources::getImage(const juce::String& name, int width, int height, float scale, const DrawFunction& draw)
+{
+	auto render = [width, height, scale, &draw]
+	{
+		juce::Image image(juce::Image::PixelFormat::ARGB,
+		                  juce::jmax(1, juce::roundToInt(width * scale)),
+		                  juce::jmax(1, juce::roundToInt(height * scale)),
+		                  true);
+
+		juce::Graphics g(image);
+		g.addTransform(juce::AffineTransform::scale(scale));
+		draw(g);
+
+		return image;
+	};
+
+	const ImageKey key{ name, width, height, juce::roundToInt(scale * 100) };
+
+	const auto it = images.find(key);
+	if (it != images.end())
+		return it->second;
+
+	releaseUnusedImages();
+	return images.emplace(key, render()).first->second;
+}
+
+
+void EditorResources::releaseUnusedImages()
+{
+	for (auto it = images.begin(); it != images.end();)
+	{
+		if (it->second.getReferenceCount() <= 1)
+			it = images.erase(it);
+		else
+			++it;
+	}
+}
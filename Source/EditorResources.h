@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    EditorResources.h
+
+    Look-and-feel, fonts and pre-rendered images shared by every open
+    editor in the process.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+struct LookAndFeel : juce::LookAndFeel_V4
+{
+	void drawRotarySlider(juce::Graphics&,
+		int x, int y, int width, int height,
+		float sliderPosProportional,
+		float rotaryStartAngle,
+		float rotaryEndAngle,
+		juce::Slider&) override;
+
+	// Body, outline and, if pointerLength is above 0, the pointer turned to angle
+	static void drawKnob(juce::Graphics& g, juce::Rectangle<float> bounds, float angle, float pointerLength);
+	static void drawKnobPointer(juce::Graphics& g, juce::Rectangle<float> bounds, float angle, float pointerLength);
+};
+
+
+/**
+	Held through a juce::SharedResourcePointer, so it exists while any editor does
+	and all of them draw with the same objects. Message thread only.
+
+	Images are keyed by name, size and display scale and rendered at the physical
+	size, so they stay sharp on high-DPI screens. juce::Image is reference counted:
+	an image no editor holds any more is dropped the next time one is added.
+*/
+class EditorResources
+{
+public:
+	LookAndFeel& getLookAndFeel() { return lookAndFeel; }
+
+	juce::Font getFont(float height);
+
+	using DrawFunction = std::function<void(juce::Graphics&)>;
+
+	// Returns the cached image, or has draw() paint a new one in logical coordinates.
+	juce::Image getImage(const juce::String& name, int width, int height, float scale, const DrawFunction& draw);
+
+	int getNumImages() const { return static_cast<int>(images.size()); }
+
+private:
+	struct ImageKey
+	{
+		juce::String name;
+		int width, height, scale;   // scale in 1/100
+
+		bool operator<(const ImageKey& other) const
+		{
+			return std::tie(name, width, height, scale) < std::tie(other.name, other.width, other.height, other.scale);
+		}
+	};
+
+	void releaseUnusedImages();
+
+	LookAndFeel lookAndFeel;
+	std::map<int, juce::Font> fonts;   // keyed by height in 1/100 px
+	std::map<ImageKey, juce::Image> images;
+};
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    FilterChain.cpp
+
+  ==============================================================================
+*/
+
+#include "FilterChain.h"
+#include "CoefficientDesign.h"
+
+
+ChainSettings  getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+	ChainSettings  settings;
+
+	settings.hiCutFreq = apvts.getRawParameterValue("HiCut Freq")->load();
+	settings.loCutFreq = apvts.getRawParameterValue("LoCut Freq")->load();
+	//	settings.hiCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HiCut Slope")->load());
+	//	settings.loCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LoCut Slope")->load());
+	settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
+	settings.peakGain = apvts.getRawParameterValue("Peak Gain")->load();
+	settings.peakQ = apvts.getRawParameterValue("Peak Q")->load();
+	settings.loCutSlope = apvts.getRawParameterValue("LoCut Slope")->load();
+	settings.hiCutSlope = apvts.getRawParameterValue("HiCut Slope")->load();
+
+	return settings;
+}
+
+
+ChainSettings  getChainSettings(const juce::ValueTree& state)
+{
+	// Parameters missing from the tree keep the defaults from createParameterLayout()
+	auto value = [&state](const juce::String& paramID, float defaultValue)
+	{
+		auto param = state.getChildWithProperty("id", paramID);
+		return param.isValid() ? static_cast<float>(param.getProperty("value")) : defaultValue;
+	};
+
+	ChainSettings  settings;
+
+	settings.hiCutFreq = value("HiCut Freq", 20000.f);
+	settings.loCutFreq = value("LoCut Freq", 20.f);
+	settings.peakFreq = value("Peak Freq", 750.f);
+	settings.peakGain = value("Peak Gain", 0.f);
+	settings.peakQ = value("Peak Q", 1.f);
+	settings.loCutSlope = static_cast<int>(value("LoCut Slope", 0.f));
+	settings.hiCutSlope = static_cast<int>(value("HiCut Slope", 0.f));
+
+	return settings;
+}
+
+
+Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+  return makePeakFilter(sampleRate,
+	  chainSettings.peakFreq,
+	  chainSettings.peakQ,
+	  juce::Decibels::decibelsToGain(chainSettings.peakGain));
+}
+
+
+Coefficients makePeakFilter(double sampleRate, float frequency, float Q, float gainFactor)
+{
+	Coefficients coefficients = new juce::dsp::IIR::Coefficients<float>(1, 0, 0, 1, 0, 0);
+	designPeakSection(coefficients->getRawCoefficients(), sampleRate, frequency, Q, gainFactor);
+
+	return coefficients;
+}
+
+
+void updateCoefficients(Coefficients &old, const Coefficients &replacements)
+{
+	old = replacements;
+}
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    FilterChain.h
+
+    Parameter snapshot types, the per-channel filter chain and the
+    coefficient design helpers shared by the processor and the editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCascade.h"
+
+
+enum Slope
+{
+	Slope_12,
+	Slope_24,
+	Slope_36,
+	Slope_48,
+	Slope_72,
+	Slope_96
+};
+
+
+// Butterworth order for a Slope; every second order section adds 12 dB/Oct.
+constexpr int getCutFilterOrder(int slope)
+{
+	return slope <= Slope_48 ? (slope + 1) * 2
+	     : slope == Slope_72 ? 12
+	     : 16;
+}
+
+constexpr int getCutFilterNumStages(int slope)
+{
+	return getCutFilterOrder(slope) / 2;
+}
+
+
+struct ChainSettings
+{
+	float peakFreq{ 0 }, peakGain{ 0 }, peakQ{ 1.f };
+	float loCutFreq{ 0 }, hiCutFreq{ 0 };
+	int loCutSlope{ Slope::Slope_12 }, hiCutSlope{ Slope::Slope_12 };
+};
+
+
+ChainSettings  getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+
+// Reads the settings straight from a saved state tree (the one getStateInformation writes),
+// for tools that run the chain without a plugin instance.
+ChainSettings  getChainSettings(const juce::ValueTree& state);
+
+using Filter = juce::dsp::IIR::Filter<float>;
+
+using Coefficients = Filter::CoefficientsPtr;
+
+/**
+	Butterworth cut section for one channel. All active second order sections run
+	in one fused pass (see BiquadCascade.h) instead of one ProcessorChain slot each,
+	so there is no per-stage dispatch or bypass branch while processing.
+
+	The coefficients always come from the float designs below; a double instance
+	widens them as they are set and keeps its state in double precision.
+*/
+template <typename SampleType>
+class CascadeFilter
+{
+public:
+	static constexpr int maxStages = maxCascadeStages;
+
+	using CoefficientArray = std::array<Coefficients, maxStages>;
+
+	void prepare(const juce::dsp::ProcessSpec&) { reset(); }
+	void reset() { cascade.reset(); }
+
+	template <typename ProcessContext>
+	void process(const ProcessContext& context) noexcept
+	{
+		auto&& inputBlock = context.getInputBlock();
+		auto&& outputBlock = context.getOutputBlock();
+
+		jassert(outputBlock.getNumChannels() == 1);
+
+		if (context.usesSeparateInputAndOutputBlocks())
+			outputBlock.copyFrom(inputBlock);
+
+		if (context.isBypassed)
+			return;
+
+		cascade.process(outputBlock.getChannelPointer(0), outputBlock.getNumSamples());
+	}
+
+	void setStage(int index, const Coefficients& coefficients)
+	{
+		jassert(coefficients->getFilterOrder() == 2);
+
+		stageCoefficients[index] = coefficients;
+
+		std::array<SampleType, 5> c;
+		std::copy_n(coefficients->getRawCoefficients(), c.size(), c.begin());
+		cascade.setStage(index, c.data());
+	}
+
+	// Selects the kernel for this many stages; a no-op unless the slope changed.
+	void setNumStages(int numStages) { cascade.setNumStages(numStages); }
+
+	int getNumStages() const { return cascade.getNumStages(); }
+	const Coefficients& getStageCoefficients(int index) const { return stageCoefficients[index]; }
+
+private:
+	CoefficientArray stageCoefficients;
+	BiquadCascade<SampleType, maxStages> cascade;
+};
+
+using CutFilter = CascadeFilter<float>;
+
+using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+
+// Same topology in double precision, for hosts with a 64-bit mix bus. The peak runs as a one
+// section cascade, so it takes the shared float coefficients without a Coefficients<double> allocation.
+using DoubleMonoChain = juce::dsp::ProcessorChain<CascadeFilter<double>, CascadeFilter<double>, CascadeFilter<double>>;
+
+enum ChainPositions
+{
+	LoCut,
+	Peak,
+	HiCut
+	};
+
+
+// Points the filter at the replacement coefficients. Only the reference count is touched,
+// so several chains can share one coefficient object without copying it.
+void updateCoefficients(Coefficients &old, const Coefficients &replacements);
+
+Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+
+// Designed with designPeakSection, which divides each term by a0 itself: at 0 dB b0 is a0 / a0,
+// exactly 1, where IIR::Coefficients multiplies by a rounded 1 / a0 and can land an ulp below.
+Coefficients makePeakFilter(double sampleRate, float frequency, float Q, float gainFactor);
+
+
+
+template<typename SampleType, typename CoefficientType>
+void updateCutFilter(CascadeFilter<SampleType>& cutFilter, const CoefficientType&  cutCoefficients, const int slope)
+{
+	const auto numStages = getCutFilterNumStages(slope);
+
+	for (int i = 0; i < numStages; i++)
+		cutFilter.setStage(i, cutCoefficients[i]);
+
+	cutFilter.setNumStages(numStages);
+}
+
+
+inline auto makeLoCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+	return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.loCutFreq,
+		sampleRate,
+		getCutFilterOrder(chainSettings.loCutSlope));
+}
+
+inline auto makeHiCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+	return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.hiCutFreq,
+		sampleRate,
+		getCutFilterOrder(chainSettings.hiCutSlope));
+}
@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEngine.h"
+#include "ResponseCurveCache.h"
+
+
+LinearPhaseEngine::LinearPhaseEngine(juce::AudioProcessorValueTreeState& apvts, BandParameters& bands)
+	: juce::Thread("Simple_eq linear phase kernel designer"),
+	  snapshot(apvts),
+	  bandParameters(bands)
+{
+}
+
+
+LinearPhaseEngine::~LinearPhaseEngine()
+{
+	release();
+}
+
+
+void LinearPhaseEngine::prepare(double newSampleRate, int maxBlockSize, int numChannels, int newKernelLength, int partitionSize)
+{
+	release();
+
+	sampleRate = newSampleRate;
+	kernelLength = juce::nextPowerOfTwo(juce::jlimit(1024, 65536, newKernelLength));
+
+	const juce::dsp::ProcessSpec spec{ sampleRate, static_cast<juce::uint32>(maxBlockSize), 1 };
+
+	convolvers.clear();
+	for (int ch = 0; ch < numChannels; ch++)
+	{
+		auto* convolver = convolvers.add(new juce::dsp::Convolution(juce::dsp::Convolution::Latency{ partitionSize }, loadQueue));
+		convolver->prepare(spec);
+	}
+
+	fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(kernelLength)));
+
+	const auto numBins = kernelLength / 2 + 1;
+	phi.resize(static_cast<size_t>(numBins));
+	magnitudesSquared.resize(static_cast<size_t>(numBins));
+	sectionMagnitudes.resize(static_cast<size_t>(numBins));
+	spectrum.resize(static_cast<size_t>(kernelLength * 2));
+
+	for (int bin = 0; bin < numBins; bin++)
+	{
+		const auto s = std::sin(juce::MathConstants<double>::pi * bin / kernelLength);
+		phi[static_cast<size_t>(bin)] = s * s;
+	}
+
+	snapshot.invalidate();
+	snapshot.refresh();
+	bandParameters.takeChangedBands(BandParameters::Kernel);
+	designKernel();
+
+	latencySamples = kernelLength / 2 + (convolvers.isEmpty() ? 0 : convolvers.getFirst()->getLatency());
+
+	if (active)
+		startThread(juce::Thread::Priority::low);
+}
+
+
+void LinearPhaseEngine::release()
+{
+	stopThread(1000);
+}
+
+
+void LinearPhaseEngine::setActive(bool shouldBeActive)
+{
+	active = shouldBeActive;
+
+	if (!active)
+		release();
+	else if (sampleRate > 0 && !isThreadRunning())
+		startThread(juce::Thread::Priority::low);
+}
+
+
+void LinearPhaseEngine::reset() noexcept
+{
+	for (auto* convolver : convolvers)
+		convolver->reset();
+}
+
+
+void LinearPhaseEngine::process(const juce::dsp::AudioBlock<float>& block) noexcept
+{
+	const auto numChannels = juce::jmin(static_cast<int>(block.getNumChannels()), convolvers.size());
+
+	for (int ch = 0; ch < numChannels; ch++)
+	{
+		auto channelBlock = block.getSingleChannelBlock(static_cast<size_t>(ch));
+		juce::dsp::ProcessContextReplacing<float> context(channelBlock);
+		convolvers.getUnchecked(ch)->process(context);
+	}
+}
+
+
+void LinearPhaseEngine::run()
+{
+	while (!threadShouldExit())
+	{
+		if (parametersChanged())
+			designKernel();
+
+		wait(pollIntervalMs);
+	}
+}
+
+
+bool LinearPhaseEngine::parametersChanged()
+{
+	snapshot.refresh();
+
+	bool changed = bandParameters.takeChangedBands(BandParameters::Kernel) != 0;
+
+	for (auto section : { ChainPositions::LoCut, ChainPositions::Peak, ChainPositions::HiCut })
+		changed = changed || designedGenerations[section] != snapshot.getGeneration(section);
+
+	return changed;
+}
+
+
+void LinearPhaseEngine::designKernel()
+{
+	const auto numBins = kernelLength / 2 + 1;
+	const auto& chainSettings = snapshot.getSettings();
+
+	for (auto section : { ChainPositions::LoCut, ChainPositions::Peak, ChainPositions::HiCut })
+		designedGenerations[section] = snapshot.getGeneration(section);
+
+	std::fill(magnitudesSquared.begin(), magnitudesSquared.end(), 1.0);
+
+	auto addSection = [this, numBins](const float* coefficients)
+	{
+		evaluateSectionMagnitudesSquared(coefficients, phi.data(), sectionMagnitudes.data(), numBins);
+
+		for (int bin = 0; bin < numBins; bin++)
+			magnitudesSquared[static_cast<size_t>(bin)] *= sectionMagnitudes[static_cast<size_t>(bin)];
+	};
+
+	addSection(makePeakFilter(chainSettings, sampleRate)->getRawCoefficients());
+
+	for (auto* coefficients : makeLoCutFilter(chainSettings, sampleRate))
+		addSection(coefficients->getRawCoefficients());
+
+	for (auto* coefficients : makeHiCutFilter(chainSettings, sampleRate))
+		addSection(coefficients->getRawCoefficients());
+
+	for (int band = 0; band < maxParametricBands; band++)
+	{
+		const auto settings = bandParameters.getSettings(band);
+		if (!settings.enabled)
+			continue;
+
+		float coefficients[5];
+		designBand(coefficients, settings, sampleRate);
+		addSection(coefficients);
+	}
+
+	// Zero-phase spectrum: real magnitudes only
+	std::fill(spectrum.begin(), spectrum.end(), 0.f);
+	for (int bin = 0; bin < numBins; bin++)
+		spectrum[static_cast<size_t>(bin * 2)] = static_cast<float>(std::sqrt(magnitudesSquared[static_cast<size_t>(bin)]));
+
+	fft->performRealOnlyInverseTransform(spectrum.data());
+
+	// The response is now centred on sample 0; rotate it to the middle and window it
+	juce::AudioBuffer<float> kernel(1, kernelLength);
+	auto* h = kernel.getWritePointer(0);
+
+	for (int n = 0; n < kernelLength; n++)
+	{
+		const auto x = juce::MathConstants<double>::twoPi * n / kernelLength;
+		const auto blackman = 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2 * x);
+
+		h[n] = spectrum[static_cast<size_t>((n + kernelLength / 2) % kernelLength)] * static_cast<float>(blackman);
+	}
+
+	for (auto* convolver : convolvers)
+	{
+		juce::AudioBuffer<float> copy(kernel);
+		convolver->loadImpulseResponse(std::move(copy),
+		                               sampleRate,
+		                               juce::dsp::Convolution::Stereo::no,
+		                               juce::dsp::Convolution::Trim::no,
+		                               juce::dsp::Convolution::Normalise::no);
+	}
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.h
+
+    Linear-phase alternative to the IIR chain: an FIR kernel with the chain's
+    magnitude response, run through uniformly partitioned FFT convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+#include "ParameterSnapshot.h"
+#include "ParametricBands.h"
+
+
+/**
+	The kernel is designed by frequency sampling: the magnitude of every section
+	(LoCut, Peak, HiCut and the enabled bands) is evaluated at the kernel's FFT bins,
+	the zero-phase spectrum is transformed back, centred and Blackman windowed.
+	That makes it symmetric, so the phase is exactly linear with a delay of half
+	the kernel length.
+
+	A background thread redesigns the kernel whenever a parameter moves and hands it
+	to one juce::dsp::Convolution per channel. Convolution does the uniformly
+	partitioned processing, with partitions of the chosen size, and crossfades from
+	the old kernel to the new one on the audio thread.
+
+	The kernel length sets the frequency resolution: a bin is sampleRate / length
+	wide, so very steep cuts near 20 Hz need the longer kernels.
+*/
+class LinearPhaseEngine  : private juce::Thread
+{
+public:
+	static constexpr int defaultKernelLength = 8192;
+	static constexpr int defaultPartitionSize = 512;
+
+	LinearPhaseEngine(juce::AudioProcessorValueTreeState& apvts, BandParameters& bandParameters);
+	~LinearPhaseEngine() override;
+
+	// Creates the convolvers and designs the first kernel; not real-time safe.
+	void prepare(double sampleRate, int maxBlockSize, int numChannels, int kernelLength, int partitionSize);
+	void release();
+
+	// Message thread. The designer thread only runs while the engine is in use.
+	void setActive(bool shouldBeActive);
+
+	// Kernel delay plus the convolver's own partition latency
+	int getLatencySamples() const { return latencySamples; }
+
+	// The whole kernel has to pass before the output falls silent
+	int getTailSamples() const { return latencySamples + kernelLength / 2; }
+
+	// Audio thread
+	void reset() noexcept;
+	void process(const juce::dsp::AudioBlock<float>& block) noexcept;
+
+private:
+	void run() override;
+
+	bool parametersChanged();
+	void designKernel();
+
+	ParameterSnapshot snapshot;
+	BandParameters& bandParameters;
+	std::array<juce::uint32, 3> designedGenerations{};
+
+	juce::dsp::ConvolutionMessageQueue loadQueue;
+	juce::OwnedArray<juce::dsp::Convolution> convolvers;   // one per channel
+
+	double sampleRate = 0;
+	int kernelLength = defaultKernelLength;
+	int latencySamples = 0;
+	bool active = false;
+
+	// Designer thread scratch
+	std::unique_ptr<juce::dsp::FFT> fft;
+	std::vector<double> phi, magnitudesSquared, sectionMagnitudes;
+	std::vector<float> spectrum;
+
+	static constexpr int pollIntervalMs = 20;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseEngine)
+};
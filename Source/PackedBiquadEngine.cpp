@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    PackedBiquadEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "PackedBiquadEngine.h"
+#include "CoefficientDesign.h"
+#include "PerformanceProbe.h"
+
+#if JUCE_USE_SIMD
+
+void PackedBiquadEngine::prepare(int numChannels, int maximumBlockSize)
+{
+	jassert(numChannels <= numLanes);
+	juce::ignoreUnused(numChannels);
+
+	frames.assign(static_cast<size_t>(maximumBlockSize), Register::expand(0.f));
+	reset();
+}
+
+
+void PackedBiquadEngine::reset()
+{
+	loCut.reset();
+	peak.reset();
+	hiCut.reset();
+}
+
+
+void PackedBiquadEngine::setCutStages(ChainPositions section, const CutFilter::CoefficientArray& coefficients, int slope)
+{
+	auto& cascade = section == ChainPositions::LoCut ? loCut : hiCut;
+	const auto numStages = getCutFilterNumStages(slope);
+
+	for (int i = 0; i < numStages; i++)
+		cascade.setStage(i, coefficients[i]->getRawCoefficients());
+
+	cascade.setNumStages(numStages);
+}
+
+
+void PackedBiquadEngine::setPeakStage(const Coefficients& coefficients)
+{
+	peak.setStage(0, coefficients->getRawCoefficients());
+	peak.setNumStages(isIdentitySection(coefficients->getRawCoefficients()) ? 0 : 1);
+}
+
+
+void PackedBiquadEngine::process(const juce::dsp::AudioBlock<float>& block, std::array<juce::uint64, 3>* stageTicks)
+{
+	// Some hosts occasionally send more than the prepared block size
+	for (size_t start = 0; start < block.getNumSamples(); start += frames.size())
+		processChunk(block.getSubBlock(start, juce::jmin(frames.size(), block.getNumSamples() - start)), stageTicks);
+}
+
+
+void PackedBiquadEngine::processChunk(const juce::dsp::AudioBlock<float>& block, std::array<juce::uint64, 3>* stageTicks)
+{
+	const auto numChannels = static_cast<int>(block.getNumChannels());
+	const auto numSamples = block.getNumSamples();
+
+	jassert(numChannels <= numLanes);
+
+	auto* interleaved = reinterpret_cast<float*>(frames.data());
+
+	for (int ch = 0; ch < numLanes; ch++)
+	{
+		if (ch < numChannels)
+		{
+			const auto* src = block.getChannelPointer(static_cast<size_t>(ch));
+			for (size_t i = 0; i < numSamples; i++)
+				interleaved[i * numLanes + ch] = src[i];
+		}
+		else
+		{
+			for (size_t i = 0; i < numSamples; i++)
+				interleaved[i * numLanes + ch] = 0.f;
+		}
+	}
+
+	// Each cascade already runs over the whole chunk, so timing them costs two counter reads
+	// apiece. The interleaving is not part of any stage.
+	auto processCascade = [&](auto& cascade, ChainPositions position)
+	{
+		if (stageTicks == nullptr)
+		{
+			cascade.process(frames.data(), numSamples);
+			return;
+		}
+
+		const auto start = PerformanceProbe::now();
+		cascade.process(frames.data(), numSamples);
+		(*stageTicks)[static_cast<size_t>(position)] += PerformanceProbe::now() - start;
+	};
+
+	processCascade(loCut, ChainPositions::LoCut);
+	processCascade(peak, ChainPositions::Peak);
+	processCascade(hiCut, ChainPositions::HiCut);
+
+	for (int ch = 0; ch < numChannels; ch++)
+	{
+		auto* dst = block.getChannelPointer(static_cast<size_t>(ch));
+		for (size_t i = 0; i < numSamples; i++)
+			dst[i] = interleaved[i * numLanes + ch];
+	}
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    PackedBiquadEngine.h
+
+    Runs the MonoChain topology for several channels in one pass by putting
+    each channel in its own lane of a juce::dsp::SIMDRegister<float>.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+#if JUCE_USE_SIMD
+
+/**
+	Processes up to numLanes channels with the same LoCut -> Peak -> HiCut stages
+	as MonoChain. The samples are interleaved into SIMD registers (channel c in lane c)
+	and each section runs as one fused cascade kernel from BiquadCascade.h over
+	the interleaved frames before the result is written back.
+
+	The kernels use the same transposed direct form II update, in the same operation
+	order, as juce::dsp::IIR::Filter, and the states are snapped to zero at the end of
+	each block exactly like the scalar filter does. The output is therefore bit-identical
+	to MonoChain as long as the compiler does not contract the multiply-adds into FMAs
+	differently for the two paths; if it does, the difference stays below 1e-6 relative
+	to full scale for the stable designs produced in FilterChain.h.
+*/
+class PackedBiquadEngine
+{
+public:
+	using Register = juce::dsp::SIMDRegister<float>;
+
+	static constexpr int numLanes = static_cast<int>(Register::size());
+
+	void prepare(int numChannels, int maximumBlockSize);
+	void reset();
+
+	void setCutStages(ChainPositions section, const CutFilter::CoefficientArray& coefficients, int slope);
+	void setPeakStage(const Coefficients& coefficients);
+
+	// The block must have at most numLanes channels. With stageTicks, the counter ticks of
+	// each cascade are added to the entry of its ChainPositions, as the profiler reports them.
+	void process(const juce::dsp::AudioBlock<float>& block, std::array<juce::uint64, 3>* stageTicks = nullptr);
+
+private:
+	void processChunk(const juce::dsp::AudioBlock<float>& block, std::array<juce::uint64, 3>* stageTicks);
+
+	BiquadCascade<Register, CutFilter::maxStages> loCut, hiCut;
+	BiquadCascade<Register, 1> peak;
+
+	std::vector<Register> frames;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PackedBiquadEngine)
+};
+
+#endif
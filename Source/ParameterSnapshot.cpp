@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.cpp
+
+  ==============================================================================
+*/
+
+#include "ParameterSnapshot.h"
+
+
+ParameterSnapshot::ParameterSnapshot(juce::AudioProcessorValueTreeState& apvts)
+	: loCutFreq (apvts.getRawParameterValue("LoCut Freq")),
+	  loCutSlope(apvts.getRawParameterValue("LoCut Slope")),
+	  peakFreq  (apvts.getRawParameterValue("Peak Freq")),
+	  peakGain  (apvts.getRawParameterValue("Peak Gain")),
+	  peakQ     (apvts.getRawParameterValue("Peak Q")),
+	  hiCutFreq (apvts.getRawParameterValue("HiCut Freq")),
+	  hiCutSlope(apvts.getRawParameterValue("HiCut Slope"))
+{
+	jassert(loCutFreq != nullptr && loCutSlope != nullptr
+		 && peakFreq != nullptr && peakGain != nullptr && peakQ != nullptr
+		 && hiCutFreq != nullptr && hiCutSlope != nullptr);
+
+	refresh();
+}
+
+
+void ParameterSnapshot::refresh()
+{
+	ChainSettings latest;
+
+	latest.loCutFreq = loCutFreq->load();
+	latest.loCutSlope = static_cast<int>(loCutSlope->load());
+	latest.peakFreq = peakFreq->load();
+	latest.peakGain = peakGain->load();
+	latest.peakQ = peakQ->load();
+	latest.hiCutFreq = hiCutFreq->load();
+	latest.hiCutSlope = static_cast<int>(hiCutSlope->load());
+
+	if (latest.loCutFreq != settings.loCutFreq || latest.loCutSlope != settings.loCutSlope)
+		++generations[ChainPositions::LoCut];
+
+	if (latest.peakFreq != settings.peakFreq || latest.peakGain != settings.peakGain || latest.peakQ != settings.peakQ)
+		++generations[ChainPositions::Peak];
+
+	if (latest.hiCutFreq != settings.hiCutFreq || latest.hiCutSlope != settings.hiCutSlope)
+		++generations[ChainPositions::HiCut];
+
+	settings = latest;
+}
+
+
+void ParameterSnapshot::invalidate()
+{
+	for (auto& generation : generations)
+		++generation;
+}
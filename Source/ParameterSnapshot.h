@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.h
+
+    Cached view of the chain parameters with a generation counter per
+    section, so only the sections whose inputs moved get redesigned.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+
+class ParameterSnapshot
+{
+public:
+	// Resolves the parameter atomics once; refresh() never does a string lookup.
+	explicit ParameterSnapshot(juce::AudioProcessorValueTreeState& apvts);
+
+	// Reloads the values and bumps the generation of every section whose inputs moved.
+	void refresh();
+
+	// Forces every section to be seen as changed, e.g. after a sample rate change.
+	void invalidate();
+
+	const ChainSettings& getSettings() const { return settings; }
+	juce::uint32 getGeneration(ChainPositions section) const { return generations[section]; }
+
+private:
+	std::atomic<float>* loCutFreq;
+	std::atomic<float>* loCutSlope;
+	std::atomic<float>* peakFreq;
+	std::atomic<float>* peakGain;
+	std::atomic<float>* peakQ;
+	std::atomic<float>* hiCutFreq;
+	std::atomic<float>* hiCutSlope;
+
+	ChainSettings settings;
+	std::array<juce::uint32, 3> generations{ 1, 1, 1 };
+
+	JUCE_DECLARE_NON_COPYABLE(ParameterSnapshot)
+};
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    ParametricBandEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "ParametricBandEngine.h"
+#include "CoefficientDesign.h"
+
+
+template <typename SampleType>
+void ParametricBandEngine<SampleType>::prepare(int newNumChannels)
+{
+	numChannels = newNumChannels;
+
+	state1.assign(static_cast<size_t>(numChannels * maxParametricBands), SampleType(0));
+	state2.assign(static_cast<size_t>(numChannels * maxParametricBands), SampleType(0));
+}
+
+
+template <typename SampleType>
+void ParametricBandEngine<SampleType>::reset()
+{
+	std::fill(state1.begin(), state1.end(), SampleType(0));
+	std::fill(state2.begin(), state2.end(), SampleType(0));
+}
+
+
+template <typename SampleType>
+void ParametricBandEngine<SampleType>::setBands(const BandCoefficientArray& coefficients, juce::uint32 enabledBands) noexcept
+{
+	// A band at 0 dB is transparent and runs as if it were disabled
+	for (int band = 0; band < maxParametricBands; band++)
+		if (isIdentitySection(coefficients[static_cast<size_t>(band)].data()))
+			enabledBands &= ~(1u << band);
+
+	const auto newlyEnabled = enabledBands & ~activeBands;
+
+	numActive = 0;
+
+	for (int band = 0; band < maxParametricBands; band++)
+	{
+		const auto bit = 1u << band;
+		if ((enabledBands & bit) == 0)
+			continue;
+
+		if ((newlyEnabled & bit) != 0)
+		{
+			for (int ch = 0; ch < numChannels; ch++)
+			{
+				state1[static_cast<size_t>(ch * maxParametricBands + band)] = SampleType(0);
+				state2[static_cast<size_t>(ch * maxParametricBands + band)] = SampleType(0);
+			}
+		}
+
+		const auto& c = coefficients[static_cast<size_t>(band)];
+		const auto slot = static_cast<size_t>(numActive++);
+
+		b0[slot] = c[0];
+		b1[slot] = c[1];
+		b2[slot] = c[2];
+		a1[slot] = c[3];
+		a2[slot] = c[4];
+		bandOfSlot[slot] = band;
+	}
+
+	activeBands = enabledBands;
+}
+
+
+template <typename SampleType>
+void ParametricBandEngine<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block, int firstChannel) noexcept
+{
+	const auto numSamples = block.getNumSamples();
+	const auto channelsInBlock = juce::jmin(static_cast<int>(block.getNumChannels()), numChannels - firstChannel);
+
+	for (int ch = 0; ch < channelsInBlock; ch++)
+	{
+		auto* data = block.getChannelPointer(static_cast<size_t>(ch));
+		auto* s1 = state1.data() + (firstChannel + ch) * maxParametricBands;
+		auto* s2 = state2.data() + (firstChannel + ch) * maxParametricBands;
+
+		for (int slot = 0; slot < numActive; slot++)
+		{
+			const auto band = bandOfSlot[static_cast<size_t>(slot)];
+			const auto cb0 = b0[static_cast<size_t>(slot)], cb1 = b1[static_cast<size_t>(slot)], cb2 = b2[static_cast<size_t>(slot)];
+			const auto ca1 = a1[static_cast<size_t>(slot)], ca2 = a2[static_cast<size_t>(slot)];
+
+			auto lv1 = s1[band];
+			auto lv2 = s2[band];
+
+			for (size_t i = 0; i < numSamples; i++)
+			{
+				const auto input = data[i];
+				const auto output = (cb0 * input) + lv1;
+				lv1 = (cb1 * input) - (ca1 * output) + lv2;
+				lv2 = (cb2 * input) - (ca2 * output);
+				data[i] = output;
+			}
+
+			JUCE_SNAP_TO_ZERO(lv1);
+			JUCE_SNAP_TO_ZERO(lv2);
+
+			s1[band] = lv1;
+			s2[band] = lv2;
+		}
+	}
+}
+
+
+template class ParametricBandEngine<float>;
+template class ParametricBandEngine<double>;
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    ParametricBandEngine.h
+
+    Runs the enabled parametric bands of every channel from structure-of-arrays
+    coefficient and state storage.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParametricBands.h"
+
+
+/**
+	setBands() packs the coefficients of the enabled bands into the first slots of
+	five contiguous arrays, so process() walks only those slots and a disabled band
+	costs nothing. Filter state is kept per band rather than per slot, so enabling
+	or disabling one band leaves the others undisturbed; a band that was just
+	enabled starts from silence.
+
+	Every band is a transposed direct form II section with the same order of
+	operations as juce::dsp::IIR::Filter. Instantiated for float and double; the
+	double one widens the designer's float coefficients in setBands().
+*/
+template <typename SampleType>
+class ParametricBandEngine
+{
+public:
+	// Allocates the state for this many channels; not real-time safe.
+	void prepare(int numChannels);
+	void reset();
+
+	// Audio thread. enabledBands has bit n set for band n; bands that design to identity are skipped.
+	void setBands(const BandCoefficientArray& coefficients, juce::uint32 enabledBands) noexcept;
+
+	bool hasActiveBands() const noexcept { return numActive > 0; }
+
+	// Processes the channels of the block as channels firstChannel, firstChannel + 1, ...
+	void process(const juce::dsp::AudioBlock<SampleType>& block, int firstChannel) noexcept;
+
+private:
+	// Slot k holds the k-th enabled band
+	std::array<SampleType, maxParametricBands> b0{}, b1{}, b2{}, a1{}, a2{};
+	std::array<int, maxParametricBands> bandOfSlot{};
+	int numActive = 0;
+
+	juce::uint32 activeBands = 0;
+
+	// Indexed [channel * maxParametricBands + band]
+	std::vector<SampleType> state1, state2;
+	int numChannels = 0;
+};
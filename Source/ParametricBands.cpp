@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    ParametricBands.cpp
+
+  ==============================================================================
+*/
+
+#include "ParametricBands.h"
+#include "CoefficientDesign.h"
+
+
+namespace
+{
+	const char* const bandParameterNames[] = { "Enabled", "Type", "Freq", "Gain", "Q" };
+
+	// Spread the default frequencies over the audible range, so enabling a band lands somewhere useful
+	float getDefaultBandFrequency(int band)
+	{
+		return std::round(juce::mapToLog10((band + 0.5f) / maxParametricBands, 20.f, 20000.f));
+	}
+}
+
+
+juce::String getBandParameterID(int band, const juce::String& name)
+{
+	return "Band " + juce::String(band + 1) + " " + name;
+}
+
+
+bool isBandParameterID(const juce::String& parameterID)
+{
+	return parameterID.startsWith("Band ");
+}
+
+
+void addBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+	const juce::StringArray types{ "Peak", "Low Shelf", "High Shelf", "Notch" };
+
+	for (int band = 0; band < maxParametricBands; band++)
+	{
+		auto id = [band](const juce::String& name) { return getBandParameterID(band, name); };
+
+		layout.add(std::make_unique<juce::AudioParameterBool>(id("Enabled"), id("Enabled"), false));
+		layout.add(std::make_unique<juce::AudioParameterChoice>(id("Type"), id("Type"), types, Band_Peak));
+		layout.add(std::make_unique<juce::AudioParameterFloat>(id("Freq"),
+		                                                       id("Freq"),
+		                                                       juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+		                                                       getDefaultBandFrequency(band)));
+		layout.add(std::make_unique<juce::AudioParameterFloat>(id("Gain"),
+		                                                       id("Gain"),
+		                                                       juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+		                                                       0.f));
+		layout.add(std::make_unique<juce::AudioParameterFloat>(id("Q"),
+		                                                       id("Q"),
+		                                                       juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+		                                                       1.f));
+	}
+}
+
+
+BandSettings getBandSettings(const juce::ValueTree& state, int band)
+{
+	auto value = [&state, band](const juce::String& name, float defaultValue)
+	{
+		auto param = state.getChildWithProperty("id", getBandParameterID(band, name));
+		return param.isValid() ? static_cast<float>(param.getProperty("value")) : defaultValue;
+	};
+
+	BandSettings settings;
+
+	settings.enabled = value("Enabled", 0.f) >= 0.5f;
+	settings.type = static_cast<int>(value("Type", Band_Peak));
+	settings.freq = value("Freq", getDefaultBandFrequency(band));
+	settings.gainInDecibels = value("Gain", 0.f);
+	settings.quality = value("Q", 1.f);
+
+	return settings;
+}
+
+
+void designBand(float* c, const BandSettings& settings, double sampleRate) noexcept
+{
+	const auto gainFactor = juce::Decibels::decibelsToGain(settings.gainInDecibels);
+
+	if (!settings.enabled)
+	{
+		c[0] = 1.f;
+		c[1] = c[2] = c[3] = c[4] = 0.f;
+		return;
+	}
+
+	switch (settings.type)
+	{
+	case Band_LowShelf:
+		designShelfSection(c, false, sampleRate, settings.freq, settings.quality, gainFactor);
+		break;
+	case Band_HighShelf:
+		designShelfSection(c, true, sampleRate, settings.freq, settings.quality, gainFactor);
+		break;
+	case Band_Notch:
+		designNotchSection(c, sampleRate, settings.freq, settings.quality);
+		break;
+	default:
+		designPeakSection(c, sampleRate, settings.freq, settings.quality, gainFactor);
+		break;
+	}
+}
+
+
+//==============================================================================
+BandParameters::BandParameters(juce::AudioProcessorValueTreeState& apvts)
+{
+	for (auto& changed : changedBands)
+		changed.store(allBands);
+
+	for (int band = 0; band < maxParametricBands; band++)
+	{
+		auto parameter = [&apvts, band](const juce::String& name) { return apvts.getParameter(getBandParameterID(band, name)); };
+
+		auto& b = bands[band];
+		b.enabled = dynamic_cast<juce::AudioParameterBool*>(parameter("Enabled"));
+		b.type = dynamic_cast<juce::AudioParameterChoice*>(parameter("Type"));
+		b.freq = dynamic_cast<juce::AudioParameterFloat*>(parameter("Freq"));
+		b.gain = dynamic_cast<juce::AudioParameterFloat*>(parameter("Gain"));
+		b.quality = dynamic_cast<juce::AudioParameterFloat*>(parameter("Q"));
+
+		jassert(b.enabled != nullptr && b.type != nullptr && b.freq != nullptr && b.gain != nullptr && b.quality != nullptr);
+
+		for (auto* name : bandParameterNames)
+		{
+			auto* param = parameter(name);
+
+			const auto index = param->getParameterIndex();
+			if (index >= static_cast<int>(bandOfParameter.size()))
+				bandOfParameter.resize(static_cast<size_t>(index + 1), -1);
+
+			bandOfParameter[static_cast<size_t>(index)] = band;
+
+			param->addListener(this);
+			listenedTo.add(param);
+		}
+	}
+}
+
+
+BandParameters::~BandParameters()
+{
+	for (auto* param : listenedTo)
+		param->removeListener(this);
+}
+
+
+BandSettings BandParameters::getSettings(int band) const
+{
+	const auto& b = bands[band];
+
+	BandSettings settings;
+
+	settings.enabled = b.enabled->get();
+	settings.type = b.type->getIndex();
+	settings.freq = b.freq->get();
+	settings.gainInDecibels = b.gain->get();
+	settings.quality = b.quality->get();
+
+	return settings;
+}
+
+
+void BandParameters::parameterValueChanged(int parameterIndex, float)
+{
+	if (parameterIndex < 0 || parameterIndex >= static_cast<int>(bandOfParameter.size()))
+		return;
+
+	const auto band = bandOfParameter[static_cast<size_t>(parameterIndex)];
+	if (band < 0)
+		return;
+
+	for (auto& changed : changedBands)
+		changed.fetch_or(1u << band);
+}
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    ParametricBands.h
+
+    The runtime-enabled parametric bands that sit next to the fixed LoCut,
+    Peak and HiCut sections: their parameters, their design, and the change
+    tracking that keeps redesigns proportional to the bands that moved.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+constexpr int maxParametricBands = 24;
+
+enum BandType
+{
+	Band_Peak,
+	Band_LowShelf,
+	Band_HighShelf,
+	Band_Notch
+};
+
+struct BandSettings
+{
+	bool enabled{ false };
+	int type{ Band_Peak };
+	float freq{ 1000.f }, gainInDecibels{ 0.f }, quality{ 1.f };
+};
+
+// Normalised { b0, b1, b2, a1, a2 } of every band, indexed by band
+using BandCoefficientArray = std::array<std::array<float, 5>, maxParametricBands>;
+
+
+// e.g. getBandParameterID(2, "Freq") == "Band 3 Freq"
+juce::String getBandParameterID(int band, const juce::String& name);
+bool isBandParameterID(const juce::String& parameterID);
+
+void addBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+
+// Reads a band from a saved state; missing parameters keep their defaults.
+BandSettings getBandSettings(const juce::ValueTree& state, int band);
+
+// Writes the section for the band, or a pass-through one if it is disabled.
+void designBand(float* coefficients, const BandSettings& settings, double sampleRate) noexcept;
+
+
+/**
+	Listens to the band parameters and keeps a bit per band for each reader, so a
+	reader only has to look at the bands that changed since it last asked. The
+	callback may come from any thread, including the audio thread during host
+	automation, and is a single atomic or.
+*/
+class BandParameters  : private juce::AudioProcessorParameter::Listener
+{
+public:
+	enum Reader
+	{
+		Designer,     // CoefficientPipeline
+		Editor,       // ResponseCurveComponent
+		Kernel,       // LinearPhaseEngine
+		numReaders
+	};
+
+	static constexpr juce::uint32 allBands = (1u << maxParametricBands) - 1;
+
+	explicit BandParameters(juce::AudioProcessorValueTreeState& apvts);
+	~BandParameters() override;
+
+	BandSettings getSettings(int band) const;
+
+	// Returns the bands changed since the last call by the same reader, and clears them.
+	juce::uint32 takeChangedBands(Reader reader) { return changedBands[reader].exchange(0); }
+
+private:
+	void parameterValueChanged(int parameterIndex, float newValue) override;
+	void parameterGestureChanged(int, bool) override {}
+
+	// The parameter objects rather than the APVTS raw values: they already hold the
+	// new value when the listener runs, the raw values may not be updated yet.
+	struct Band
+	{
+		juce::AudioParameterBool* enabled;
+		juce::AudioParameterChoice* type;
+		juce::AudioParameterFloat* freq;
+		juce::AudioParameterFloat* gain;
+		juce::AudioParameterFloat* quality;
+	};
+
+	std::array<Band, maxParametricBands> bands;
+
+	juce::Array<juce::AudioProcessorParameter*> listenedTo;
+	std::vector<int> bandOfParameter;     // by parameter index, -1 for the other parameters
+
+	std::array<std::atomic<juce::uint32>, numReaders> changedBands;
+
+	JUCE_DECLARE_NON_COPYABLE(BandParameters)
+};
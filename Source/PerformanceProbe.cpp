@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+
+    PerformanceProbe.cpp
+
+  ==============================================================================
+*/
+
+#include "PerformanceProbe.h"
+
+
+PerformanceProbe::PerformanceProbe()
+	: juce::Thread("Simple_eq performance probe")
+{
+}
+
+
+PerformanceProbe::~PerformanceProbe()
+{
+	stopThread(1000);
+}
+
+
+const char* PerformanceProbe::getStageName(Stage stage)
+{
+	switch (stage)
+	{
+	case LoCut:     return "locut";
+	case Peak:      return "peak";
+	case HiCut:     return "hicut";
+	case Block:     return "block";
+	case Filters:   return "filters";
+	case Redesign:  return "redesign";
+	case Designer:  return "designer";
+	case numStages: break;
+	}
+
+	return "";
+}
+
+
+void PerformanceProbe::setEnabled(bool shouldBeEnabled)
+{
+	if (!isCompiledIn || shouldBeEnabled == enabled.load())
+		return;
+
+	if (shouldBeEnabled)
+	{
+		for (auto& ring : rings)
+			if (ring == nullptr)
+				ring = std::make_unique<Ring>();
+
+		if (histograms == nullptr)
+		{
+			const juce::ScopedLock sl(statsLock);
+			histograms = std::make_unique<std::array<StageHistograms, numStages>>();
+		}
+
+		enabled.store(true, std::memory_order_release);
+		startThread(juce::Thread::Priority::low);
+	}
+	else
+	{
+		// The rings stay: a block that saw the probe enabled may still be recording
+		enabled.store(false, std::memory_order_release);
+		stopThread(1000);
+	}
+}
+
+
+void PerformanceProbe::prepare(double newSampleRate, int newBlockSize)
+{
+	sampleRate.store(newSampleRate);
+	blockSize.store(newBlockSize);
+}
+
+
+void PerformanceProbe::record(Stage stage, juce::uint64 ticks, int numSamples) noexcept
+{
+	rings[stage == Designer ? DesignerThread : AudioThread]->push({ ticks,
+	                                                                static_cast<juce::uint32>(juce::jmax(0, numSamples)),
+	                                                                static_cast<juce::uint32>(stage) });
+}
+
+
+void PerformanceProbe::Ring::push(const Record& record) noexcept
+{
+	int start1, size1, start2, size2;
+	fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+	if (size1 == 0)
+	{
+		numDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	records[static_cast<size_t>(start1)] = record;
+	fifo.finishedWrite(1);
+}
+
+
+void PerformanceProbe::run()
+{
+	calibrationTicks = now();
+	calibrationTime = juce::Time::getHighResolutionTicks();
+
+	while (!threadShouldExit())
+	{
+		wait(readIntervalMs);
+		drain();
+	}
+}
+
+
+// The counter's rate is measured against the high resolution clock over the whole
+// time the thread has run, so the estimate keeps getting better.
+void PerformanceProbe::drain()
+{
+	const auto elapsedTicks = now() - calibrationTicks;
+	const auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - calibrationTime);
+
+	if (elapsedTicks == 0 || elapsedSeconds <= 0)
+		return;
+
+	nsPerTick = elapsedSeconds * 1.0e9 / static_cast<double>(elapsedTicks);
+
+	const juce::ScopedLock sl(statsLock);
+
+	for (auto& ring : rings)
+	{
+		int start1, size1, start2, size2;
+		ring->fifo.prepareToRead(ring->fifo.getNumReady(), start1, size1, start2, size2);
+
+		auto addRecords = [this, &ring](int start, int size)
+		{
+			for (int i = start; i < start + size; i++)
+			{
+				const auto& record = ring->records[static_cast<size_t>(i)];
+				auto& stage = (*histograms)[record.stage];
+				const auto ns = static_cast<double>(record.ticks) * nsPerTick;
+
+				stage.perRecord.add(ns);
+				stage.maxNs = juce::jmax(stage.maxNs, ns);
+
+				if (record.numSamples > 0)
+					stage.perSample.add(ns / record.numSamples);
+			}
+		};
+
+		addRecords(start1, size1);
+		addRecords(start2, size2);
+
+		ring->fifo.finishedRead(size1 + size2);
+	}
+}
+
+
+void PerformanceProbe::Histogram::add(double ns) noexcept
+{
+	const auto position = ns > 0 ? (std::log2(ns) - minExponent) * binsPerOctave : 0.0;
+	++counts[static_cast<size_t>(juce::jlimit(0, numBins - 1, static_cast<int>(position)))];
+	++total;
+}
+
+
+// The geometric centre of the bin the percentile falls in
+double PerformanceProbe::Histogram::getPercentile(double fraction) const noexcept
+{
+	if (total == 0)
+		return 0;
+
+	const auto target = juce::jmax(static_cast<juce::uint64>(1), static_cast<juce::uint64>(std::ceil(fraction * static_cast<double>(total))));
+	juce::uint64 sum = 0;
+
+	for (int bin = 0; bin < numBins; bin++)
+	{
+		sum += counts[static_cast<size_t>(bin)];
+
+		if (sum >= target)
+			return std::exp2((bin + 0.5) / binsPerOctave + minExponent);
+	}
+
+	return std::exp2(static_cast<double>(numBins) / binsPerOctave + minExponent);
+}
+
+
+PerformanceProbe::Report PerformanceProbe::getReport() const
+{
+	Report report;
+	report.sampleRate = sampleRate.load();
+	report.blockSize = blockSize.load();
+
+	for (const auto& ring : rings)
+		if (ring != nullptr)
+			report.numDropped += ring->numDropped.load();
+
+	const juce::ScopedLock sl(statsLock);
+
+	if (histograms == nullptr)
+		return report;
+
+	for (int stage = 0; stage < numStages; stage++)
+	{
+		const auto& histogram = (*histograms)[static_cast<size_t>(stage)];
+		auto& stats = report.stages[static_cast<size_t>(stage)];
+
+		stats.count = histogram.perRecord.total;
+		stats.p50Ns = histogram.perRecord.getPercentile(0.5);
+		stats.p99Ns = histogram.perRecord.getPercentile(0.99);
+		stats.maxNs = histogram.maxNs;
+		stats.p50NsPerSample = histogram.perSample.getPercentile(0.5);
+		stats.p99NsPerSample = histogram.perSample.getPercentile(0.99);
+		stats.p99DeadlineShare = stats.p99NsPerSample * report.sampleRate * 1.0e-9;
+	}
+
+	return report;
+}
+
+
+void PerformanceProbe::reset()
+{
+	for (auto& ring : rings)
+		if (ring != nullptr)
+			ring->numDropped.store(0);
+
+	const juce::ScopedLock sl(statsLock);
+
+	if (histograms != nullptr)
+		*histograms = {};
+}
+
+
+bool PerformanceProbe::writeCsv(const juce::File& file) const
+{
+	const auto report = getReport();
+
+	juce::String csv("stage,count,p50_ns,p99_ns,max_ns,p50_ns_per_sample,p99_ns_per_sample,p99_deadline_share,sample_rate,block_size,dropped\n");
+
+	for (int stage = 0; stage < numStages; stage++)
+	{
+		const auto& stats = report.stages[static_cast<size_t>(stage)];
+
+		csv << getStageName(static_cast<Stage>(stage)) << ","
+		    << juce::String(static_cast<juce::int64>(stats.count)) << ","
+		    << stats.p50Ns << "," << stats.p99Ns << "," << stats.maxNs << ","
+		    << stats.p50NsPerSample << "," << stats.p99NsPerSample << ","
+		    << stats.p99DeadlineShare << ","
+		    << report.sampleRate << "," << report.blockSize << ","
+		    << juce::String(static_cast<juce::int64>(report.numDropped)) << "\n";
+	}
+
+	return file.replaceWithText(csv);
+}
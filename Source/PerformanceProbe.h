@@ -0,0 +1,194 @@
+/*
+  ==============================================================================
+
+    PerformanceProbe.h
+
+    Times processBlock, its stages and the coefficient redesigns with the CPU's
+    time stamp counter, and aggregates the timings into histograms on a reader
+    thread. Only built with SIMPLE_EQ_PROFILING=1.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+#ifndef SIMPLE_EQ_PROFILING
+ #define SIMPLE_EQ_PROFILING 0
+#endif
+
+#if SIMPLE_EQ_PROFILING && JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+
+/**
+	Each thread that records has its own single-producer ring of records
+	(stage, counter ticks, host samples), so recording is a counter read and a
+	wait-free fifo write. Records that do not fit are dropped and counted. The
+	reader thread runs only while the probe is enabled; it drains the rings every
+	readIntervalMs, converts ticks to nanoseconds with a calibration against the
+	high resolution clock, and adds them to log-spaced histograms with eight bins
+	per octave, so percentiles are within about 5%.
+
+	The share of the deadline is the time per host sample times the host sample
+	rate: 1.0 means the stage alone took as long as the block lasts.
+
+	Without SIMPLE_EQ_PROFILING, isEnabled() is a constant false, every timed
+	branch compiles away and no ring is ever allocated.
+*/
+class PerformanceProbe  : private juce::Thread
+{
+public:
+	enum Stage
+	{
+		LoCut = ChainPositions::LoCut,   // the three stages, summed over every channel group and backend
+		Peak = ChainPositions::Peak,
+		HiCut = ChainPositions::HiCut,
+		Block,                            // all of processBlock
+		Filters,                          // the minimum-phase chain, all stages and channels
+		Redesign,                         // smoothing and dynamic peak redesigns on the audio thread
+		Designer,                         // redesigns on the designer thread, not tied to a block
+		numStages
+	};
+
+	static constexpr bool isCompiledIn = SIMPLE_EQ_PROFILING != 0;
+
+	PerformanceProbe();
+	~PerformanceProbe() override;
+
+	static const char* getStageName(Stage stage);
+
+	// Message thread. The rings are allocated the first time it is enabled and kept from then on.
+	void setEnabled(bool shouldBeEnabled);
+	bool isEnabled() const noexcept { return isCompiledIn && enabled.load(std::memory_order_acquire); }
+
+	// prepareToPlay: the host rate and block size the deadline is taken from
+	void prepare(double sampleRate, int blockSize);
+
+	// Counter ticks, from the time stamp counter on x86 and the high resolution clock elsewhere
+	static juce::uint64 now() noexcept
+	{
+	   #if SIMPLE_EQ_PROFILING && JUCE_INTEL
+		return static_cast<juce::uint64>(__rdtsc());
+	   #else
+		return static_cast<juce::uint64>(juce::Time::getHighResolutionTicks());
+	   #endif
+	}
+
+	// Audio or designer thread, only after isEnabled() returned true. numSamples
+	// is at the host rate, 0 for work that is not part of a block.
+	void record(Stage stage, juce::uint64 ticks, int numSamples) noexcept;
+
+	// Times its own lifetime as one record. Costs a load and a branch while the probe is off.
+	class Scope
+	{
+	public:
+		Scope(PerformanceProbe& p, Stage s, int n) noexcept
+			: probe(p.isEnabled() ? &p : nullptr), stage(s), numSamples(n), start(probe != nullptr ? now() : 0) {}
+
+		~Scope()
+		{
+			if (probe != nullptr)
+				probe->record(stage, now() - start, numSamples);
+		}
+
+	private:
+		PerformanceProbe* probe;
+		Stage stage;
+		int numSamples;
+		juce::uint64 start;
+
+		JUCE_DECLARE_NON_COPYABLE(Scope)
+	};
+
+	struct StageStats
+	{
+		juce::uint64 count = 0;
+		double p50Ns = 0, p99Ns = 0, maxNs = 0;     // per record
+		double p50NsPerSample = 0, p99NsPerSample = 0;
+		double p99DeadlineShare = 0;
+	};
+
+	struct Report
+	{
+		std::array<StageStats, numStages> stages;
+		juce::uint64 numDropped = 0;
+		double sampleRate = 0;
+		int blockSize = 0;
+	};
+
+	// Message thread. What the reader thread has aggregated since the last reset.
+	Report getReport() const;
+	void reset();
+
+	bool writeCsv(const juce::File& file) const;
+
+private:
+	struct Record
+	{
+		juce::uint64 ticks;
+		juce::uint32 numSamples;
+		juce::uint32 stage;
+	};
+
+	struct Ring
+	{
+		static constexpr int capacity = 1 << 13;
+
+		juce::AbstractFifo fifo{ capacity };
+		std::array<Record, capacity> records;
+		std::atomic<juce::uint64> numDropped{ 0 };
+
+		void push(const Record& record) noexcept;
+	};
+
+	// The designer thread has its own ring; everything else is recorded on the audio thread
+	enum Producer { AudioThread, DesignerThread, numProducers };
+	std::array<std::unique_ptr<Ring>, numProducers> rings;
+
+	struct Histogram
+	{
+		static constexpr int binsPerOctave = 8;
+		static constexpr int minExponent = -4;    // 1/16 ns
+		static constexpr int numBins = (32 - minExponent) * binsPerOctave;
+
+		std::array<juce::uint64, numBins> counts{};
+		juce::uint64 total = 0;
+
+		void add(double ns) noexcept;
+		double getPercentile(double fraction) const noexcept;
+	};
+
+	struct StageHistograms
+	{
+		Histogram perRecord, perSample;
+		double maxNs = 0;
+	};
+
+	void run() override;
+	void drain();
+
+	static constexpr int readIntervalMs = 100;
+
+	std::atomic<bool> enabled{ false };
+	std::atomic<double> sampleRate{ 44100 };
+	std::atomic<int> blockSize{ 512 };
+
+	// Reader thread
+	juce::uint64 calibrationTicks = 0;
+	juce::int64 calibrationTime = 0;
+	double nsPerTick = 0;
+
+	// Allocated along with the rings, guarded by statsLock
+	juce::CriticalSection statsLock;
+	std::unique_ptr<std::array<StageHistograms, numStages>> histograms;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceProbe)
+};
@@ -22,59 +22,85 @@ void LookAndFeel::drawRotarySlider(juce::Graphics& g,
 
   auto bounds = Rectangle<float>(x ,y ,width, height);
 
-  g.setColour(Colour(97u, 18u, 167u));
-  g.fillEllipse(bounds);
+  auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider);
+  if (rswl == nullptr)
+  {
+	drawKnob(g, bounds, 0.f, 0.f);
+	return;
+  }
 
-  g.setColour(Colour(255u, 154u, 1u));
-  g.drawEllipse(bounds, 1.f);
+  jassert(rotaryStartAngle < rotaryEndAngle);
 
+  auto sliderAngRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
+  auto pointerLength = bounds.getHeight() * 0.5f - rswl->getTextHeight() * 1.5f;
+
+  // The pointer is a small path and is drawn live at its exact angle
+  if (rswl->drawKnobBody(g, bounds))
+	drawKnobPointer(g, bounds, sliderAngRad, pointerLength);
+  else
+	drawKnob(g, bounds, sliderAngRad, pointerLength);
+
+  // Only the value is drawn live
+  g.setFont(rswl->getFont());
+  auto text = rswl->getDisplayString();
+  auto strWidth = g.getCurrentFont().getStringWidth(text);
+
+  Rectangle<float> r;
+  r.setSize(strWidth + 4, rswl->getTextHeight() + 2);
+  r.setCentre(bounds.getCentre());
+
+  g.setColour(juce::Colours::black);
+  g.fillRect(r);
+
+  g.setColour(juce::Colours::white);
+  g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
+}
 
-  if (auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider))
-  {
-	auto center = bounds.getCentre();
 
-	Path p;
-	Rectangle<float> r;
+void LookAndFeel::drawKnob(juce::Graphics& g, juce::Rectangle<float> bounds, float angle, float pointerLength)
+{
+  using namespace juce;
 
-	r.setLeft(center.getX() - 2);
-	r.setRight(center.getX() + 2);
-	r.setTop(bounds.getY());
-	r.setBottom(center.getY() - rswl->getTextHeight()*1.5);
+  g.setColour(Colour(97u, 18u, 167u));
+  g.fillEllipse(bounds);
 
-	p.addRoundedRectangle(r, 2.f);
-	//  p.addRectangle(r);
+  g.setColour(Colour(255u, 154u, 1u));
+  g.drawEllipse(bounds, 1.f);
 
-	jassert(rotaryStartAngle < rotaryEndAngle);
+  drawKnobPointer(g, bounds, angle, pointerLength);
+}
 
-	auto sliderAngRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
 
-	p.applyTransform(AffineTransform().rotated(sliderAngRad, center.getX(), center.getY()));
+void LookAndFeel::drawKnobPointer(juce::Graphics& g, juce::Rectangle<float> bounds, float angle, float pointerLength)
+{
+  using namespace juce;
+
+  if (pointerLength <= 0)
+	return;
 
-	g.fillPath(p);
+  g.setColour(Colour(255u, 154u, 1u));
 
-	g.setFont(rswl->getTextHeight());
-	auto text = rswl->getDisplayString();
-	auto strWidth = g.getCurrentFont().getStringWidth(text);
+  auto center = bounds.getCentre();
 
-	r.setSize(strWidth + 4, rswl->getTextHeight() + 2);
-	r.setCentre(bounds.getCentre());
+  Path p;
+  Rectangle<float> r;
 
-	g.setColour(juce::Colours::black);
-	g.fillRect(r);
+  r.setLeft(center.getX() - 2);
+  r.setRight(center.getX() + 2);
+  r.setTop(bounds.getY());
+  r.setBottom(bounds.getY() + pointerLength);
 
-	g.setColour(juce::Colours::white);
-	g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
-  }
+  p.addRoundedRectangle(r, 2.f);
+  p.applyTransform(AffineTransform().rotated(angle, center.getX(), center.getY()));
 
+  g.fillPath(p);
 }
 
+
 void RotarySliderWithLabels::paint(juce::Graphics& g)
 {
 	using namespace juce;
 
-	auto startAng = degreesToRadians(180.f + 30.f);
-	auto endAng   = degreesToRadians(180.f - 30.f) + MathConstants<float>::twoPi;
-
 	auto range = getRange();
 	auto sliderBounds = getSliderBounds();
 
@@ -88,16 +114,26 @@ void RotarySliderWithLabels::paint(juce::Graphics& g)
 										sliderBounds.getWidth(), 
 										sliderBounds.getHeight(),
 										jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0), 
-					  					startAng, 
-										endAng, 
+					  					startAngle, 
+										endAngle, 
 										*this);
 
+	if (useKnobImages && labelsImage.isValid())
+		g.drawImage(labelsImage, getLocalBounds().toFloat());
+	else
+		drawLabels(g);
+}
+
+
+void RotarySliderWithLabels::drawLabels(juce::Graphics& g)
+{
+	using namespace juce;
 
 	auto center = getSliderBounds().toFloat().getCentre();
 	auto radius = getSliderBounds().getWidth()*0.5f;
 
 	g.setColour(juce::Colour(0u, 172u, 1u));
-	g.setFont(getTextHeight());
+	g.setFont(getFont());
 
 	auto numChoices = labels.size();
 
@@ -106,7 +142,7 @@ void RotarySliderWithLabels::paint(juce::Graphics& g)
 		auto pos = labels[i].pos;
 		jassert(0.f <= pos);
 		jassert(1.f >= pos);
-		auto ang = jmap(pos, 0.f, 1.f, startAng, endAng);
+		auto ang = jmap(pos, 0.f, 1.f, startAngle, endAngle);
 
 		auto c = center.getPointOnCircumference(radius + getTextHeight()*0.5f + 1, ang);
 
@@ -121,6 +157,46 @@ void RotarySliderWithLabels::paint(juce::Graphics& g)
 }
 
 
+// The knob body and the labels only change with the size, so they are rendered here
+// and shared with every slider of the same size through EditorResources.
+void RotarySliderWithLabels::resized()
+{
+	juce::Slider::resized();
+
+	const auto size = getSliderBounds().getWidth();
+	if (size <= 0)
+	{
+		knobBody = {};
+		labelsImage = {};
+		return;
+	}
+
+	const auto scale = juce::Component::getApproximateScaleFactorForComponent(this);
+
+	// With a pixel around it for the outline
+	knobBody = resources->getImage("KnobBody", size + 2, size + 2, scale, [size](juce::Graphics& g)
+	{
+		LookAndFeel::drawKnob(g, juce::Rectangle<float>(1.f, 1.f, static_cast<float>(size), static_cast<float>(size)), 0.f, 0.f);
+	});
+
+	juce::String labelsName("KnobLabels");
+	for (const auto& label : labels)
+		labelsName << " " << label.pos << ":" << label.label;
+
+	labelsImage = resources->getImage(labelsName, getWidth(), getHeight(), scale, [this](juce::Graphics& g) { drawLabels(g); });
+}
+
+
+bool RotarySliderWithLabels::drawKnobBody(juce::Graphics& g, juce::Rectangle<float> bounds) const
+{
+	if (!useKnobImages || !knobBody.isValid())
+		return false;
+
+	g.drawImage(knobBody, bounds.expanded(1.f));
+	return true;
+}
+
+
 juce::Rectangle<int> RotarySliderWithLabels::getSliderBounds() const
 {
 	auto bounds =  getLocalBounds();
@@ -174,16 +250,20 @@ juce::String  RotarySliderWithLabels::getDisplayString() const
 
 
 
-ResponseCurveComponent::ResponseCurveComponent(Simple_eqAudioProcessor& p) : audioProcessor(p)
+ResponseCurveComponent::ResponseCurveComponent(Simple_eqAudioProcessor& p) : audioProcessor(p),
+	analyser(p.preEqAnalyserFifo, p.postEqAnalyserFifo)
 {
+	// The bands are tracked by BandParameters, so only the changed ones get redesigned
 	const auto& params = audioProcessor.getParameters();
 	for (auto param : params)
 	{
-		param->addListener(this);
+		auto* paramWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(param);
+		if (paramWithID == nullptr || !isBandParameterID(paramWithID->paramID))
+			param->addListener(this);
 	}
 
-	updateChain();
-	startTimerHz(60);
+	audioProcessor.bandParameters.takeChangedBands(BandParameters::Editor);
+	updateChain(BandParameters::allBands);
 }
 
 
@@ -204,111 +284,112 @@ void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float new
 }
 
 
-void ResponseCurveComponent::timerCallback()
+juce::Rectangle<int> ResponseCurveComponent::updateFrame()
 {
-	if (parametersChanged.compareAndSetBool(false, true))
-	{
-		//DBG("params changed");
-	 // // update the monochain
-		//auto chainSettings = getChainSettings(audioProcessor.apvts);
-		//auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-		//updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+	juce::Rectangle<float> dirty;
 
-		//auto loCutCoefficients = makeLoCutFilter(chainSettings, audioProcessor.getSampleRate());
-		//auto hiCutCoefficients = makeHiCutFilter(chainSettings, audioProcessor.getSampleRate());
-		//updateCutFilter(monoChain.get<ChainPositions::LoCut>(), loCutCoefficients, chainSettings.loCutSlope);
-		//updateCutFilter(monoChain.get<ChainPositions::HiCut>(), hiCutCoefficients, chainSettings.hiCutSlope);
+	const auto changedBands = audioProcessor.bandParameters.takeChangedBands(BandParameters::Editor);
 
-		updateChain();
+	if (parametersChanged.compareAndSetBool(false, true) || changedBands != 0)
+	{
+		// Where the curve was and where it is now, with room for the stroke
+		const auto oldCurveBounds = responseCurve.getBounds().expanded(2.f);
 
-		//// signal a repaint
-		repaint();
+		if (updateChain(changedBands))
+			dirty = oldCurveBounds.getUnion(responseCurve.getBounds().expanded(2.f));
 	}
+
+	if (analyser.pullNewPaths())
+		dirty = dirty.getUnion(getAnalysisArea().toFloat().expanded(1.f));
+
+	return dirty.getSmallestIntegerContainer();
 }
 
 
 
-void ResponseCurveComponent::updateChain()
+bool ResponseCurveComponent::updateChain(juce::uint32 bandsToDesign)
 {
-	// update the monochain
+	// update the coefficients
 	auto chainSettings = getChainSettings(audioProcessor.apvts);
-	auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-	updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+	auto sampleRate = audioProcessor.getProcessingSampleRate();
 
-	auto loCutCoefficients = makeLoCutFilter(chainSettings, audioProcessor.getSampleRate());
-	auto hiCutCoefficients = makeHiCutFilter(chainSettings, audioProcessor.getSampleRate());
-	updateCutFilter(monoChain.get<ChainPositions::LoCut>(), loCutCoefficients, chainSettings.loCutSlope);
-	updateCutFilter(monoChain.get<ChainPositions::HiCut>(), hiCutCoefficients, chainSettings.hiCutSlope);
-}
+	chainCoefficients.peak = makePeakFilter(chainSettings, sampleRate);
 
-void ResponseCurveComponent::paint(juce::Graphics& g)
-{
-	using namespace juce;
+	auto loCutCoefficients = makeLoCutFilter(chainSettings, sampleRate);
+	for (int i = 0; i < loCutCoefficients.size(); i++)
+		chainCoefficients.loCut[i] = loCutCoefficients[i];
+	chainCoefficients.loCutSlope = chainSettings.loCutSlope;
 
-	// (Our component is opaque, so we must completely fill the background with a solid colour)
-	g.fillAll(Colours::black);    
+	auto hiCutCoefficients = makeHiCutFilter(chainSettings, sampleRate);
+	for (int i = 0; i < hiCutCoefficients.size(); i++)
+		chainCoefficients.hiCut[i] = hiCutCoefficients[i];
+	chainCoefficients.hiCutSlope = chainSettings.hiCutSlope;
 
-	g.drawImage(background, getLocalBounds().toFloat());
+	if (responseCurveCache.getSampleRate() != sampleRate)
+	{
+		responseCurveCache.setFrequencies(getAnalysisArea().getWidth(), sampleRate);
+		bandsToDesign = BandParameters::allBands;
+	}
+
+	for (int band = 0; band < maxParametricBands; band++)
+	{
+		const auto bit = 1u << band;
+		if ((bandsToDesign & bit) == 0)
+			continue;
 
-	//auto responseArea = getLocalBounds();
-	auto responseArea = getAnalysisArea();  // getRenderArea();
+		const auto settings = audioProcessor.bandParameters.getSettings(band);
+		designBand(chainCoefficients.bands[static_cast<size_t>(band)].data(), settings, sampleRate);
 
-	auto w = responseArea.getWidth();
+		chainCoefficients.enabledBands = settings.enabled ? (chainCoefficients.enabledBands | bit) : (chainCoefficients.enabledBands & ~bit);
+	}
 
-	auto& locut = monoChain.get<ChainPositions::LoCut>();
-	auto& peak = monoChain.get<ChainPositions::Peak>();
-	auto& hicut = monoChain.get<ChainPositions::HiCut>();
+	return updateResponseCurve();
+}
 
-	auto sampleRate = audioProcessor.getSampleRate();
 
-	std::vector<double>  mags;
-	mags.resize(w);
+// Re-evaluates only the sections whose coefficients changed, and rebuilds the path if the curve moved.
+bool ResponseCurveComponent::updateResponseCurve()
+{
+	responseCurveCache.setChain(chainCoefficients);
 
-	for (int i = 0; i < w; i++)
-	{
-		double mag = 1.f;
-		auto freq = mapToLog10(double(i) / double(w), 20., 20000.);
-
-		if (!monoChain.isBypassed<ChainPositions::Peak>())
-			mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-		if (!locut.isBypassed<0>())
-			mag *= locut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		if (!locut.isBypassed<1>())
-			mag *= locut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		if (!locut.isBypassed<2>())
-			mag *= locut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		if (!locut.isBypassed<3>())
-			mag *= locut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-		if (!hicut.isBypassed<0>())
-			mag *= hicut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		if (!hicut.isBypassed<1>())
-			mag *= hicut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		if (!hicut.isBypassed<2>())
-			mag *= hicut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-		if (!hicut.isBypassed<3>())
-			mag *= hicut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-		mags[i] = Decibels::gainToDecibels(mag);
-	}
+	if (!responseCurveCache.update())
+		return false;
 
-	Path responseCurve;
+	auto responseArea = getAnalysisArea();
+	const auto& mags = responseCurveCache.getDecibels();
 
-	const double outputMin = responseArea.getBottom();
-	const double outputMax = responseArea.getY();
+	const float outputMin = responseArea.getBottom();
+	const float outputMax = responseArea.getY();
 
-	auto map = [outputMin, outputMax](double input)
+	auto map = [outputMin, outputMax](float input)
 	{
-		return jmap(input, -24.0, 24.0, outputMin, outputMax);
+		return juce::jmap(input, -24.f, 24.f, outputMin, outputMax);
 	};
 
+	responseCurve.clear();
+	responseCurve.preallocateSpace(3 * static_cast<int>(mags.size()) + 3);
 	responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
 
-	for (size_t i = 0; i < mags.size(); i++)
-	{
+	for (size_t i = 1; i < mags.size(); i++)
 		responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
-	}
+
+	return true;
+}
+
+void ResponseCurveComponent::paint(juce::Graphics& g)
+{
+	using namespace juce;
+
+	// (Our component is opaque, so we must completely fill the background with a solid colour)
+	g.fillAll(Colours::black);    
+
+	g.drawImage(background, getLocalBounds().toFloat());
+
+	g.setColour(Colours::skyblue.withAlpha(0.5f));
+	analyser.strokePath(g, SpectrumAnalyser::PreEq, PathStrokeType(1.f));
+
+	g.setColour(Colours::orange.withAlpha(0.8f));
+	analyser.strokePath(g, SpectrumAnalyser::PostEq, PathStrokeType(1.f));
 
 	//g.setColour(Colours::beige);
 	//g.drawRoundedRectangle(getRenderArea().toFloat(), 4.f, 1.f);
@@ -325,12 +406,20 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
 
 void ResponseCurveComponent::resized()
 {
-	//using namespace juce;
+	background = resources->getImage("ResponseCurveGrid", getWidth(), getHeight(),
+	                                  juce::Component::getApproximateScaleFactorForComponent(this),
+	                                  [this](juce::Graphics& g) { drawGrid(g); });
+
+	analyser.setPlotBounds(getAnalysisArea().toFloat());
 
-	background = juce::Image(juce::Image::PixelFormat::RGB, getWidth(), getHeight(), true);
+	responseCurveCache.setFrequencies(getAnalysisArea().getWidth(), audioProcessor.getProcessingSampleRate());
+	updateResponseCurve();
+}
 
-	juce::Graphics g(background);
 
+// Only depends on the component's size
+void ResponseCurveComponent::drawGrid(juce::Graphics& g)
+{
 	juce::Array<float>  freqs
 	{
 		20,30,50,100,
@@ -379,7 +468,7 @@ void ResponseCurveComponent::resized()
 
 	g.setColour(juce::Colours::lightgrey);
 	const int fontHeight = 10;
-	g.setFont(fontHeight);
+	g.setFont(resources->getFont(fontHeight));
 
 	for (int i = 0; i < freqs.size(); i++)
 	{
@@ -407,10 +496,120 @@ void ResponseCurveComponent::resized()
 		g.drawFittedText(str, r, juce::Justification::centred, 1);
 	}
 
+	//g.drawRect(getAnalysisArea());
+}
+
 
+void ResponseCurveComponent::mouseDown(const juce::MouseEvent& event)
+{
+	if (event.mods.isPopupMenu())
+		showOptionsMenu();
+}
 
 
-	//g.drawRect(getAnalysisArea());
+void ResponseCurveComponent::showOptionsMenu()
+{
+	juce::PopupMenu fftSizes;
+	for (int order = SpectrumAnalyser::minFftOrder; order <= SpectrumAnalyser::maxFftOrder; order++)
+		fftSizes.addItem(juce::String(1 << order), true, analyser.getFftOrder() == order, [this, order] { analyser.setFftOrder(order); });
+
+	juce::PopupMenu averaging;
+	for (auto frames : { 1, 2, 4, 8, 16, 32 })
+		averaging.addItem(frames == 1 ? juce::String("Off") : juce::String(frames) + " frames", true,
+			analyser.getAveragingFrames() == frames, [this, frames] { analyser.setAveragingFrames(frames); });
+
+	auto addSourceItem = [this](juce::PopupMenu& menu, const juce::String& name, SpectrumAnalyser::Source source)
+	{
+		const auto enabled = analyser.isSourceEnabled(source);
+		menu.addItem(name, true, enabled, [this, source, enabled]
+		{
+			analyser.setSourceEnabled(source, !enabled);
+			repaint();
+		});
+	};
+
+	juce::PopupMenu menu;
+	addSourceItem(menu, "Pre-EQ spectrum", SpectrumAnalyser::PreEq);
+	addSourceItem(menu, "Post-EQ spectrum", SpectrumAnalyser::PostEq);
+	menu.addSeparator();
+	menu.addSubMenu("FFT size", fftSizes);
+	menu.addSubMenu("Averaging", averaging);
+
+	auto& processor = audioProcessor;
+
+	juce::PopupMenu phase;
+	for (auto mode : { PhaseMode::Minimum, PhaseMode::Linear })
+		phase.addItem(mode == PhaseMode::Minimum ? "Minimum" : "Linear", true,
+			processor.getPhaseMode() == mode, [&processor, mode] { processor.setPhaseMode(mode); });
+
+	juce::PopupMenu kernelLengths;
+	for (auto length : { 4096, 8192, 16384, 32768 })
+		kernelLengths.addItem(juce::String(length), true, processor.getLinearPhaseKernelLength() == length,
+			[&processor, length] { processor.setLinearPhaseKernelLength(length); });
+
+	juce::PopupMenu partitionSizes;
+	for (auto size : { 128, 256, 512, 1024, 2048, 4096 })
+		partitionSizes.addItem(juce::String(size), true, processor.getLinearPhasePartitionSize() == size,
+			[&processor, size] { processor.setLinearPhasePartitionSize(size); });
+
+	// The coefficients are redesigned for the new rate, so the curve has to follow
+	auto setOversampling = [this](int factor, OversamplingFilter filter)
+	{
+		audioProcessor.setOversampling(factor, filter);
+		updateChain(BandParameters::allBands);
+		repaint();
+	};
+
+	juce::PopupMenu oversampling;
+	for (auto factor : { 1, 2, 4, 8 })
+		oversampling.addItem(factor == 1 ? juce::String("Off") : juce::String(factor) + "x", true,
+			processor.getOversamplingFactor() == factor, [setOversampling, &processor, factor] { setOversampling(factor, processor.getOversamplingFilter()); });
+
+	oversampling.addSeparator();
+	for (auto filter : { OversamplingFilter::PolyphaseIIR, OversamplingFilter::PolyphaseFIR })
+		oversampling.addItem(filter == OversamplingFilter::PolyphaseIIR ? "IIR half-band filters" : "FIR half-band filters (linear phase)", true,
+			processor.getOversamplingFilter() == filter, [setOversampling, &processor, filter] { setOversampling(processor.getOversamplingFactor(), filter); });
+
+	// The thresholds and times are ordinary parameters, for the host to show and automate
+	auto addToggleItem = [&processor](juce::PopupMenu& subMenu, const juce::String& name, const juce::String& parameterID)
+	{
+		auto* parameter = processor.apvts.getParameter(parameterID);
+		const auto isOn = parameter->getValue() >= 0.5f;
+
+		subMenu.addItem(name, true, isOn, [parameter, isOn]
+		{
+			parameter->beginChangeGesture();
+			parameter->setValueNotifyingHost(isOn ? 0.f : 1.f);
+			parameter->endChangeGesture();
+		});
+	};
+
+	juce::PopupMenu dynamicPeak;
+	addToggleItem(dynamicPeak, "Enabled", "Peak Dynamic");
+	addToggleItem(dynamicPeak, "Detect from sidechain", "Peak Sidechain");
+
+	menu.addSeparator();
+	menu.addItem("Double precision filter state", !processor.isUsingDoublePrecision(),
+		processor.isDoublePrecisionState() || processor.isUsingDoublePrecision(),
+		[&processor] { processor.setDoublePrecisionState(!processor.isDoublePrecisionState()); });
+	menu.addItem("State variable filters", true, processor.getProcessingBackend() == ProcessingBackend::StateVariable, [&processor]
+	{
+		const auto isStateVariable = processor.getProcessingBackend() == ProcessingBackend::StateVariable;
+		processor.setProcessingBackend(isStateVariable ? Simple_eqAudioProcessor::defaultBackend : ProcessingBackend::StateVariable);
+	});
+	menu.addSubMenu("Dynamic peak", dynamicPeak);
+	menu.addSubMenu("Oversampling", oversampling);
+	menu.addSubMenu("Phase", phase);
+	menu.addSubMenu("Kernel length", kernelLengths);
+	menu.addSubMenu("Partition size", partitionSizes);
+
+	if (onOptionsMenu)
+	{
+		menu.addSeparator();
+		onOptionsMenu(menu);
+	}
+
+	menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this));
 }
 
 
@@ -477,19 +676,44 @@ Simple_eqAudioProcessorEditor::Simple_eqAudioProcessorEditor (Simple_eqAudioProc
 	hiCutFreqSlider.labels.add({ 1.f, "20kHz" });
 
 	loCutSlopeSlider.labels.add({ 0.f, "12" });
-	loCutSlopeSlider.labels.add({ 1.f, "48" });
+	loCutSlopeSlider.labels.add({ 1.f, "96" });
 
 	hiCutSlopeSlider.labels.add({ 0.f, "12" });
-	hiCutSlopeSlider.labels.add({ 1.f, "48" });
+	hiCutSlopeSlider.labels.add({ 1.f, "96" });
 
 	for (auto comp : getComps())
 	{
 		addAndMakeVisible(comp);
 	}
 
+	responseCurveComponent.onOptionsMenu = [this](juce::PopupMenu& menu)
+	{
+		menu.addItem("Show frame time", true, showFrameTime, [this]
+		{
+			showFrameTime = !showFrameTime;
+			repaint(getFrameTimeArea());
+		});
+
+		if (!PerformanceProbe::isCompiledIn)
+			return;
+
+		auto& probe = audioProcessor.getPerformanceProbe();
+		const auto profiling = probe.isEnabled();
+
+		menu.addItem("Profile processBlock", true, profiling, [this, &probe, profiling]
+		{
+			probe.setEnabled(!profiling);
+			repaint(getProfileArea());
+		});
+		menu.addItem("Reset profile", profiling, false, [&probe] { probe.reset(); });
+		menu.addItem("Save profile as CSV...", profiling, false, [this] { saveProfile(); });
+	};
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
     setSize (600, 480);
+
+	updateFrameScheduling();
 }
 
 Simple_eqAudioProcessorEditor::~Simple_eqAudioProcessorEditor()
@@ -502,11 +726,38 @@ void Simple_eqAudioProcessorEditor::paint (juce::Graphics& g)
 {
 	using namespace juce;
 
+	paintStartTicks = Time::getHighResolutionTicks();
+
     // (Our component is opaque, so we must completely fill the background with a solid colour)
 	g.fillAll(Colours::black);     // (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
 
 }
 
+
+// Runs after the children, so the time since paint() is the editor's whole repaint
+void Simple_eqAudioProcessorEditor::paintOverChildren (juce::Graphics& g)
+{
+	using namespace juce;
+
+	pendingFrameMs += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - paintStartTicks) * 1000;
+
+	if (audioProcessor.getPerformanceProbe().isEnabled())
+		paintProfile(g);
+
+	if (!showFrameTime)
+		return;
+
+	auto area = getFrameTimeArea();
+
+	g.setColour(Colours::black.withAlpha(0.7f));
+	g.fillRect(area);
+
+	g.setColour(Colours::white);
+	g.setFont(11.f);
+	g.drawFittedText("GUI " + String(averageFrameMs, 2) + " ms, peak " + String(peakFrameMs, 2) + " ms",
+		area, Justification::centred, 1);
+}
+
 void Simple_eqAudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
@@ -548,3 +799,136 @@ std::vector<juce::Component*> Simple_eqAudioProcessorEditor::getComps()
 		&responseCurveComponent
 	};
 }
+
+
+void Simple_eqAudioProcessorEditor::visibilityChanged()
+{
+	updateFrameScheduling();
+}
+
+
+void Simple_eqAudioProcessorEditor::parentHierarchyChanged()
+{
+	updateFrameScheduling();
+}
+
+
+// Off screen there are no frames at all, and the analyser stops taking audio
+void Simple_eqAudioProcessorEditor::updateFrameScheduling()
+{
+	const auto showing = isShowing();
+
+	responseCurveComponent.setAnalyserPaused(!showing);
+
+	if (showing && vBlankAttachment == nullptr)
+		vBlankAttachment = std::make_unique<juce::VBlankAttachment>(this, [this] { renderFrame(); });
+	else if (!showing)
+		vBlankAttachment.reset();
+}
+
+
+void Simple_eqAudioProcessorEditor::renderFrame()
+{
+	// A minimised window is not reported by any callback, but is not showing either
+	const auto showing = isShowing();
+	responseCurveComponent.setAnalyserPaused(!showing);
+
+	if (!showing)
+		return;
+
+	const auto startTicks = juce::Time::getHighResolutionTicks();
+
+	// Everything that changed since the last frame goes into one repaint
+	auto dirty = responseCurveComponent.updateFrame();
+	if (!dirty.isEmpty())
+		dirty += responseCurveComponent.getPosition();
+
+	const auto frameMs = pendingFrameMs + juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000;
+	pendingFrameMs = 0;
+
+	averageFrameMs += (frameMs - averageFrameMs) * 0.05;
+	peakFrameMs = juce::jmax(frameMs, peakFrameMs * 0.99);
+
+	// The readouts are refreshed a few times a second, so they do not keep the editor busy
+	const auto now = juce::Time::getMillisecondCounterHiRes();
+	const auto profiling = audioProcessor.getPerformanceProbe().isEnabled();
+
+	if ((showFrameTime || profiling) && now - lastOverlayRepaint > 250)
+	{
+		lastOverlayRepaint = now;
+
+		if (showFrameTime)
+			dirty = dirty.getUnion(getFrameTimeArea());
+		if (profiling)
+			dirty = dirty.getUnion(getProfileArea());
+	}
+
+	if (!dirty.isEmpty())
+		repaint(dirty);
+}
+
+
+juce::Rectangle<int> Simple_eqAudioProcessorEditor::getFrameTimeArea() const
+{
+	return { getWidth() - 184, getHeight() - 18, 180, 14 };
+}
+
+
+juce::Rectangle<int> Simple_eqAudioProcessorEditor::getProfileArea() const
+{
+	const auto height = 13 * (PerformanceProbe::numStages + 2);
+	return { 4, getHeight() - height - 22, 330, height };
+}
+
+
+// One line per stage: p50 and p99 per block, max, and the p99 share of the block's duration
+void Simple_eqAudioProcessorEditor::paintProfile(juce::Graphics& g)
+{
+	using namespace juce;
+
+	const auto report = audioProcessor.getPerformanceProbe().getReport();
+	auto area = getProfileArea();
+
+	g.setColour(Colours::black.withAlpha(0.7f));
+	g.fillRect(area);
+
+	g.setColour(Colours::white);
+	g.setFont(Font(Font::getDefaultMonospacedFontName(), 11.f, Font::plain));
+
+	auto drawLine = [&g, &area](const String& text)
+	{
+		g.drawText(text, area.removeFromTop(13).reduced(4, 0), Justification::centredLeft, false);
+	};
+
+	auto formatMicroseconds = [](double ns) { return String(ns * 1.0e-3, 1).paddedLeft(' ', 8); };
+
+	drawLine("stage      p50 us   p99 us   max us  p99 load");
+
+	for (int stage = 0; stage < PerformanceProbe::numStages; stage++)
+	{
+		const auto& stats = report.stages[static_cast<size_t>(stage)];
+
+		drawLine(String(PerformanceProbe::getStageName(static_cast<PerformanceProbe::Stage>(stage))).paddedRight(' ', 9)
+		         + formatMicroseconds(stats.p50Ns) + " " + formatMicroseconds(stats.p99Ns) + " " + formatMicroseconds(stats.maxNs)
+		         + String(stats.p99DeadlineShare * 100, 1).paddedLeft(' ', 9) + "%");
+	}
+
+	drawLine(String(report.blockSize) + " samples at " + String(report.sampleRate, 0) + " Hz, "
+	         + String(static_cast<int64>(report.numDropped)) + " dropped");
+}
+
+
+void Simple_eqAudioProcessorEditor::saveProfile()
+{
+	profileChooser = std::make_unique<juce::FileChooser>("Save profile",
+		juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("Simple_eq profile.csv"), "*.csv");
+
+	profileChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+	                            | juce::FileBrowserComponent::warnAboutOverwriting,
+		[this](const juce::FileChooser& chooser)
+		{
+			const auto file = chooser.getResult();
+			if (file != juce::File())
+				audioProcessor.getPerformanceProbe().writeCsv(file);
+		});
+}
@@ -10,17 +10,9 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
-
-
-struct LookAndFeel : juce::LookAndFeel_V4
-{
-	void drawRotarySlider(juce::Graphics&,
-		int x, int y, int width, int height,
-		float sliderPosProportional,
-		float rotaryStartAngle,
-		float rotaryEndAngle,
-		juce::Slider&) override;
-};
+#include "SpectrumAnalyser.h"
+#include "ResponseCurveCache.h"
+#include "EditorResources.h"
 
 
 struct RotarySliderWithLabels : juce::Slider
@@ -29,7 +21,8 @@ struct RotarySliderWithLabels : juce::Slider
 		param(&rap),
 		suffix(unitSuffix)
 	{
-		setLookAndFeel(&lnf);
+		// One look-and-feel for every slider of every open editor
+		setLookAndFeel(&resources->getLookAndFeel());
    }
 
 	~RotarySliderWithLabels()
@@ -45,22 +38,38 @@ struct RotarySliderWithLabels : juce::Slider
 
 	juce::Array<LabelPos> labels;
 
+	static constexpr float startAngle = juce::degreesToRadians(180.f + 30.f);
+	static constexpr float endAngle = juce::degreesToRadians(180.f - 30.f) + juce::MathConstants<float>::twoPi;
+
 	void paint(juce::Graphics& g) override;
+	void resized() override;
 	juce::Rectangle<int> getSliderBounds() const;
 	int getTextHeight() const { return 14; }
+	juce::Font getFont() const { return resources->getFont(static_cast<float>(getTextHeight())); }
 	juce::String getDisplayString() const;
 
+	// Draws the pre-rendered body and outline, or returns false when there is no image to draw
+	bool drawKnobBody(juce::Graphics& g, juce::Rectangle<float> bounds) const;
+
+	// Off draws the knob and its labels live on every paint, as a reference for timing
+	void setUseKnobImages(bool shouldUseImages) { useKnobImages = shouldUseImages; }
+
 private:
-	LookAndFeel lnf;
+	juce::SharedResourcePointer<EditorResources> resources;
 	juce::RangedAudioParameter* param;
 	juce::String suffix;
 
+	// The knob without its pointer, and the min/max labels
+	juce::Image knobBody, labelsImage;
+	bool useKnobImages = true;
+
+	void drawLabels(juce::Graphics& g);
+
 };
 
 
 struct ResponseCurveComponent : juce::Component,
-	juce::AudioProcessorParameter::Listener,
-	juce::Timer
+	juce::AudioProcessorParameter::Listener
 {
 	ResponseCurveComponent(Simple_eqAudioProcessor&);
 	~ResponseCurveComponent();
@@ -68,19 +77,39 @@ struct ResponseCurveComponent : juce::Component,
 
 	void parameterValueChanged(int parameterIndex, float newValue) override;
 	void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override {}
-	void timerCallback() override;
+
+	// Called by the editor once per frame. Picks up parameter and analyser changes and
+	// returns the area they touched, empty if nothing needs repainting.
+	juce::Rectangle<int> updateFrame();
+
+	void setAnalyserPaused(bool shouldBePaused) { analyser.setPaused(shouldBePaused); }
+
+	// Lets the editor add its own items to the right-click menu
+	std::function<void(juce::PopupMenu&)> onOptionsMenu;
 
 	void paint(juce::Graphics&) override;
 	void resized() override;  // is called first time before paint
 
+	void mouseDown(const juce::MouseEvent& event) override;   // right click: analyser settings
+
 private:
 	Simple_eqAudioProcessor& audioProcessor;
 	juce::Atomic<bool> parametersChanged{ false };
-	MonoChain monoChain;
+	ChainCoefficients chainCoefficients;   // only the coefficients, no filter state
 
-	void updateChain();
+	ResponseCurveCache responseCurveCache;
+	juce::Path responseCurve;
 
-	juce::Image  background;
+	SpectrumAnalyser analyser;
+	void showOptionsMenu();
+
+	// Both return whether the curve changed
+	bool updateChain(juce::uint32 bandsToDesign);
+	bool updateResponseCurve();
+
+	juce::SharedResourcePointer<EditorResources> resources;
+	juce::Image  background;   // shared with other editors of the same size
+	void drawGrid(juce::Graphics& g);
 
 	juce::Rectangle<int> getRenderArea();
 	juce::Rectangle<int> getAnalysisArea();
@@ -99,8 +128,12 @@ public:
 
     //==============================================================================
     void paint (juce::Graphics&) override;
+    void paintOverChildren (juce::Graphics&) override;
     void resized() override;
 
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
+
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -129,6 +162,24 @@ private:
 
 	std::vector<juce::Component*> getComps();
 
+	// Frames follow the display's refresh, and only while the editor is on screen
+	std::unique_ptr<juce::VBlankAttachment> vBlankAttachment;
+	void updateFrameScheduling();
+	void renderFrame();
+
+	// The editor's own CPU time per frame: the update in renderFrame plus the paint it caused
+	bool showFrameTime = false;
+	juce::int64 paintStartTicks = 0;
+	double pendingFrameMs = 0, averageFrameMs = 0, peakFrameMs = 0;
+	double lastOverlayRepaint = 0;
+	juce::Rectangle<int> getFrameTimeArea() const;
+
+	// The processor's PerformanceProbe report, while profiling is on
+	juce::Rectangle<int> getProfileArea() const;
+	void paintProfile(juce::Graphics& g);
+	void saveProfile();
+	std::unique_ptr<juce::FileChooser> profileChooser;
+
 
    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Simple_eqAudioProcessorEditor)
 };
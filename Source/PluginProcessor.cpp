@@ -16,12 +16,20 @@ Simple_eqAudioProcessor::Simple_eqAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        )
 #endif
 {
+	rampCoefficients.peak = new juce::dsp::IIR::Coefficients<float>(1, 0, 0, 1, 0, 0);
+
+	for (auto& c : rampCoefficients.loCut)
+		c = new juce::dsp::IIR::Coefficients<float>(1, 0, 0, 1, 0, 0);
+
+	for (auto& c : rampCoefficients.hiCut)
+		c = new juce::dsp::IIR::Coefficients<float>(1, 0, 0, 1, 0, 0);
 }
 
 Simple_eqAudioProcessor::~Simple_eqAudioProcessor()
@@ -63,7 +71,7 @@ bool Simple_eqAudioProcessor::isMidiEffect() const
 
 double Simple_eqAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailSeconds.load();
 }
 
 int Simple_eqAudioProcessor::getNumPrograms()
@@ -102,23 +110,122 @@ void Simple_eqAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
+	const auto numChannels = getTotalNumOutputChannels();
+
+	prepareFilterChain(sampleRate, samplesPerBlock);
+	performanceProbe.prepare(sampleRate, samplesPerBlock);
+
+	preEqAnalyserFifo.prepare(sampleRate);
+	postEqAnalyserFifo.prepare(sampleRate);
+
+	activePhaseMode = requestedPhaseMode.load();
+	linearPhase.prepare(sampleRate, samplesPerBlock, numChannels, linearPhaseKernelLength.load(), linearPhasePartitionSize.load());
+	updateLatency();
+	updateTail();
+}
+
+
+// Everything that runs at the oversampled rate. The coefficients are designed at that rate,
+// so a peak near the host's Nyquist keeps its shape instead of cramping.
+void Simple_eqAudioProcessor::prepareFilterChain(double hostSampleRate, int hostBlockSize)
+{
+	const auto numChannels = getTotalNumOutputChannels();
+	const auto order = oversamplingOrder.load();
+
+	oversampling.reset();
+	if (order > 0 && numChannels > 0)
+	{
+		const auto filterType = oversamplingFilter.load() == OversamplingFilter::PolyphaseIIR
+			? juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR
+			: juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple;
+
+		oversampling = std::make_unique<juce::dsp::Oversampling<float>>(static_cast<size_t>(numChannels), static_cast<size_t>(order), filterType, true, true);
+		oversampling->initProcessing(static_cast<size_t>(hostBlockSize));
+	}
+
+	// The double chains only exist while something runs them: a 64-bit host, or the double state option
+	useDoubleState = doublePrecisionState.load();
+	const auto needsDoubleChains = isUsingDoublePrecision() || useDoubleState;
+
+	doubleOversampling.reset();
+	if (needsDoubleChains && order > 0 && numChannels > 0)
+	{
+		const auto filterType = oversamplingFilter.load() == OversamplingFilter::PolyphaseIIR
+			? juce::dsp::Oversampling<double>::filterHalfBandPolyphaseIIR
+			: juce::dsp::Oversampling<double>::filterHalfBandFIREquiripple;
+
+		doubleOversampling = std::make_unique<juce::dsp::Oversampling<double>>(static_cast<size_t>(numChannels), static_cast<size_t>(order), filterType, true, true);
+		doubleOversampling->initProcessing(static_cast<size_t>(hostBlockSize));
+	}
+
+	doubleScratch.setSize(useDoubleState ? numChannels : 0, juce::jmax(1, hostBlockSize));
+	floatScratch.setSize(isUsingDoublePrecision() ? numChannels : 0, juce::jmax(1, hostBlockSize));
+
+	const auto sampleRate = hostSampleRate * (1 << order);
+	const auto samplesPerBlock = hostBlockSize * (1 << order);
+	processingSampleRate.store(sampleRate);
+
 	juce::dsp::ProcessSpec spec;
 
 	spec.maximumBlockSize = samplesPerBlock;
 	spec.numChannels = 1;
 	spec.sampleRate = sampleRate;
 
-	leftChain.prepare(spec);
-	rightChain.prepare(spec);
+	chains.clear();
+	for (int ch = 0; ch < numChannels; ch++)
+		chains.add(new MonoChain())->prepare(spec);
 
-	updateFilters();
+	doubleChains.clear();
+	for (int ch = 0; needsDoubleChains && ch < numChannels; ch++)
+		doubleChains.add(new DoubleMonoChain())->prepare(spec);
+
+   #if JUCE_USE_SIMD
+	packedEngines.clear();
+	for (int first = 0; first < numChannels; first += PackedBiquadEngine::numLanes)
+	{
+		auto* engine = packedEngines.add(new PackedBiquadEngine());
+		engine->prepare(juce::jmin(PackedBiquadEngine::numLanes, numChannels - first), samplesPerBlock);
+	}
+   #endif
+
+	stageTicks.assign(static_cast<size_t>(getNumChannelGroups()), {});
+
+	// The audio thread takes one group itself, and there is no point in more threads than cores
+	const auto numWorkers = juce::jmin(getNumChannelGroups() - 1, juce::SystemStats::getNumCpus() - 1);
+
+	workerPool.reset();
+	if (parallelChannelProcessing.load() && numWorkers > 0)
+		workerPool = std::make_unique<ChannelWorkerPool>(numWorkers);
+
+	activeBackend = requestedBackend.load();
 
+	stateVariableEngine.prepare(sampleRate, numChannels, samplesPerBlock);
+	doubleStateVariableEngine.prepare(sampleRate, needsDoubleChains ? numChannels : 0, samplesPerBlock);
+
+	dynamicPeak.prepare(hostSampleRate, sampleRate, hostBlockSize);
+	dynamicPeakActive = false;
+	appliedPeakGainOffset = 0;
+
+	bandEngine.prepare(numChannels);
+	doubleBandEngine.prepare(needsDoubleChains ? numChannels : 0);
+
+	appliedGenerations = {};
+	silentSamples = 0;
+	skippingSilence = false;
+	samplesSinceControlUpdate = controlInterval;   // the first block always runs the control update
+	resetSmoothing(sampleRate);
+	coefficientPipeline.prepare(sampleRate);
+	updateFilters();
 }
 
 void Simple_eqAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+
+	coefficientPipeline.release();
+	linearPhase.release();
+	workerPool.reset();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -128,15 +235,13 @@ bool Simple_eqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel gets its own chain, so any layout works, from mono
+    // up to immersive formats such as 7.1.4.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
+    // (the sidechain only feeds the dynamic peak's detector, so any layout works there too)
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
@@ -150,6 +255,7 @@ bool Simple_eqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 void Simple_eqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+	PerformanceProbe::Scope blockScope(performanceProbe, PerformanceProbe::Block, buffer.getNumSamples());
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -176,18 +282,484 @@ void Simple_eqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
     ////////////    // ..do something to the data...
     ////////////}
 
+	// Only the main bus is filtered; the sidechain is just listened to
+	auto mainBuffer = getBusBuffer(buffer, false, 0);
+
+	if (!useDoubleState && processTinyBlock(mainBuffer, oversampling != nullptr))
+		return;
+
+	juce::dsp::AudioBlock<float> block(mainBuffer);
+
+	beginBlock();
+	updateDynamicPeak(buffer);
+
+	preEqAnalyserFifo.push(mainBuffer);
+
+	if (!canSkipBlock(block))
+	{
+		if (activePhaseMode == PhaseMode::Linear)
+		{
+			linearPhase.process(block);
+		}
+		else if (useDoubleState)
+		{
+			processConverted(block, doubleScratch, [this](const juce::dsp::AudioBlock<double>& doubleBlock)
+			{
+				processFilterChain(doubleBlock, doubleOversampling.get());
+			});
+		}
+		else
+		{
+			processFilterChain(block, oversampling.get());
+		}
+	}
+
+	postEqAnalyserFifo.push(mainBuffer);
+}
+
+
+void Simple_eqAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+	juce::ScopedNoDenormals noDenormals;
+	PerformanceProbe::Scope blockScope(performanceProbe, PerformanceProbe::Block, buffer.getNumSamples());
+
+	for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
+		buffer.clear(i, 0, buffer.getNumSamples());
+
+	auto mainBuffer = getBusBuffer(buffer, false, 0);
+
+	if (processTinyBlock(mainBuffer, doubleOversampling != nullptr))
+		return;
+
+	juce::dsp::AudioBlock<double> block(mainBuffer);
+
+	beginBlock();
+	updateDynamicPeak(buffer);
+
+	preEqAnalyserFifo.push(mainBuffer);
+
+	if (!canSkipBlock(block))
+	{
+		// juce::dsp::Convolution only comes in float
+		if (activePhaseMode == PhaseMode::Linear)
+		{
+			processConverted(block, floatScratch, [this](const juce::dsp::AudioBlock<float>& floatBlock)
+			{
+				linearPhase.process(floatBlock);
+			});
+		}
+		else
+		{
+			processFilterChain(block, doubleOversampling.get());
+		}
+	}
+
+	postEqAnalyserFifo.push(mainBuffer);
+}
+
+
+// Shared by both processBlock overloads: picks up mode changes and new coefficients.
+void Simple_eqAudioProcessor::beginBlock()
+{
+	const auto phaseMode = requestedPhaseMode.load();
+
+	if (activeBackend != requestedBackend.load() || activePhaseMode != phaseMode)
+	{
+		// Whatever ramp was running is meaningless after a switch, and the state is cleared anyway
+		resetSmoothing(processingSampleRate.load());
+		appliedPeakGainOffset = 0;
+
+		activeBackend = requestedBackend.load();
+		activePhaseMode = phaseMode;
+
+		resetFilterState();
+
+		silentSamples = 0;
+		skippingSilence = false;
+		updateTail();
+	}
+
+	// The IIR coefficients are kept current in linear mode too, so switching back is seamless
+	if (activePhaseMode == PhaseMode::Minimum)
+		updateSmoothingTargets();
+
 	updateFilters();
 
-	juce::dsp::AudioBlock<float> block(buffer);
+	activeReblocking = reblocking.load();
+	samplesSinceControlUpdate = 0;
+}
+
+
+// Between two control updates, a block of a few samples only runs through the filters and
+// the analysers. The silence count must be at zero, so leaving it uncounted can only delay
+// skipping silence, never start it while the filters still ring.
+template <typename SampleType>
+bool Simple_eqAudioProcessor::processTinyBlock(juce::AudioBuffer<SampleType>& mainBuffer, bool hasOversampling)
+{
+	const auto numSamples = mainBuffer.getNumSamples();
 
-	auto leftBlock  = block.getSingleChannelBlock(0);
-	auto rightBlock = block.getSingleChannelBlock(1);
+	if (!activeReblocking || numSamples > tinyBlockSize || samplesSinceControlUpdate + numSamples > controlInterval
+	    || hasOversampling || activePhaseMode != PhaseMode::Minimum || activeBackend == ProcessingBackend::StateVariable
+	    || dynamicPeakActive || silentSamples != 0 || isAnySectionRamping())
+		return false;
 
-	juce::dsp::ProcessContextReplacing<float> leftContext (leftBlock);
-	juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+	samplesSinceControlUpdate += numSamples;
 
-	leftChain.process(leftContext);
-    rightChain.process(rightContext);
+	preEqAnalyserFifo.push(mainBuffer);
+	processChannels(juce::dsp::AudioBlock<SampleType>(mainBuffer));
+	postEqAnalyserFifo.push(mainBuffer);
+
+	return true;
+}
+
+
+// Runs the detector over the block's input before anything is filtered. Linear mode bakes
+// one fixed kernel, so the dynamics only act on the minimum-phase chain.
+template <typename SampleType>
+void Simple_eqAudioProcessor::updateDynamicPeak(juce::AudioBuffer<SampleType>& buffer)
+{
+	const auto wasActive = dynamicPeakActive;
+	dynamicPeakActive = dynamicPeak.update() && activePhaseMode == PhaseMode::Minimum;
+
+	if (!dynamicPeakActive)
+	{
+		// One more update takes the peak back to its static gain
+		if (wasActive)
+			sectionRamping[ChainPositions::Peak] = true;
+
+		return;
+	}
+
+	const auto useSidechain = dynamicPeak.wantsSidechain() && getBusCount(true) > 1 && getChannelCountOfBus(true, 1) > 0;
+	auto detector = getBusBuffer(buffer, true, useSidechain ? 1 : 0);
+
+	dynamicPeak.analyse(juce::dsp::AudioBlock<const SampleType>(detector), smoothingTargets.getSettings());
+	dynamicPeakSamples.fetch_add(static_cast<juce::uint64>(buffer.getNumSamples()), std::memory_order_relaxed);
+}
+
+
+void Simple_eqAudioProcessor::resetFilterState()
+{
+	for (auto* chain : chains)
+		chain->reset();
+	for (auto* chain : doubleChains)
+		chain->reset();
+   #if JUCE_USE_SIMD
+	for (auto* engine : packedEngines)
+		engine->reset();
+   #endif
+	stateVariableEngine.reset();
+	doubleStateVariableEngine.reset();
+	bandEngine.reset();
+	doubleBandEngine.reset();
+	linearPhase.reset();
+
+	if (oversampling != nullptr)
+		oversampling->reset();
+	if (doubleOversampling != nullptr)
+		doubleOversampling->reset();
+}
+
+
+// Counts silent input. Once it has lasted longer than the tail, the filters have rung out
+// and processing would only turn silence into silence, so the block is left as it is.
+template <typename SampleType>
+bool Simple_eqAudioProcessor::canSkipBlock(const juce::dsp::AudioBlock<SampleType>& block)
+{
+	const auto numSamples = static_cast<int>(block.getNumSamples());
+	const auto threshold = static_cast<SampleType>(silenceThreshold);
+
+	for (size_t ch = 0; ch < block.getNumChannels(); ch++)
+	{
+		const auto range = juce::FloatVectorOperations::findMinAndMax(block.getChannelPointer(ch), numSamples);
+
+		if (range.getStart() < -threshold || range.getEnd() > threshold)
+		{
+			silentSamples = 0;
+			skippingSilence = false;
+			return false;
+		}
+	}
+
+	silentSamples += numSamples;
+
+	if (silentSamples <= tailSamples || isAnySectionRamping())
+		return false;
+
+	// The input has been below silenceThreshold (-160 dBFS) for longer than the filters take to
+	// decay by 120 dB, so what is left in the state is negligible; clear it so the next note starts clean
+	if (!skippingSilence)
+	{
+		resetFilterState();
+		skippingSilence = true;
+	}
+
+	return true;
+}
+
+
+// The minimum-phase path at the processing rate, in either precision
+template <typename SampleType>
+void Simple_eqAudioProcessor::processFilterChain(juce::dsp::AudioBlock<SampleType> block, juce::dsp::Oversampling<SampleType>* oversampler)
+{
+	PerformanceProbe::Scope filtersScope(performanceProbe, PerformanceProbe::Filters, static_cast<int>(block.getNumSamples()));
+
+	auto filterBlock = oversampler != nullptr ? oversampler->processSamplesUp(block) : block;
+
+	// The dynamic peak's envelope is indexed at the host rate, at the end of each sub-block
+	const auto factor = oversampler != nullptr ? oversampler->getOversamplingFactor() : static_cast<size_t>(1);
+	auto getHostSample = [factor](size_t start, size_t length) { return static_cast<int>((start + length - 1) / factor); };
+
+	if (activeBackend == ProcessingBackend::StateVariable)
+	{
+		auto& engine = [this]() -> StateVariableEngine<SampleType>&
+		{
+			if constexpr (std::is_same_v<SampleType, float>)
+				return stateVariableEngine;
+			else
+				return doubleStateVariableEngine;
+		}();
+
+		// The engine ramps every sample itself; the chunks only bound its ramp buffers,
+		// or the distance between two gains of the dynamic peak
+		const auto chunkSize = static_cast<size_t>(dynamicPeakActive ? DynamicPeak::updateInterval
+		                                                             : engine.getMaximumBlockSize());
+
+		for (size_t start = 0; start < filterBlock.getNumSamples(); start += chunkSize)
+		{
+			auto chunk = filterBlock.getSubBlock(start, juce::jmin(chunkSize, filterBlock.getNumSamples() - start));
+
+			rampStateVariableEngine(engine, static_cast<int>(chunk.getNumSamples()), getHostSample(start, chunk.getNumSamples()));
+			processChannels(chunk);
+		}
+	}
+	else if (!isAnySectionRamping() && !dynamicPeakActive)
+	{
+		processChannels(filterBlock);
+	}
+	else
+	{
+		auto subBlockSize = static_cast<size_t>(smoothingSubBlockSize.load());
+		if (dynamicPeakActive)
+			subBlockSize = juce::jmin(subBlockSize, static_cast<size_t>(DynamicPeak::updateInterval));
+
+		for (size_t start = 0; start < filterBlock.getNumSamples(); start += subBlockSize)
+		{
+			auto subBlock = filterBlock.getSubBlock(start, juce::jmin(subBlockSize, filterBlock.getNumSamples() - start));
+
+			updateSmoothedSections(static_cast<int>(subBlock.getNumSamples()), getHostSample(start, subBlock.getNumSamples()));
+			processChannels(subBlock);
+		}
+	}
+
+	if (oversampler != nullptr)
+		oversampler->processSamplesDown(block);
+
+	if (performanceProbe.isEnabled())
+		recordStageTimes(static_cast<int>(block.getNumSamples()));
+}
+
+
+// Once per block: what the groups added up for each stage, and the redesigns in between
+void Simple_eqAudioProcessor::recordStageTimes(int numSamples)
+{
+	std::array<juce::uint64, 3> totals{};
+
+	for (auto& group : stageTicks)
+	{
+		for (size_t stage = 0; stage < totals.size(); stage++)
+			totals[stage] += group.ticks[stage];
+
+		group.ticks = {};
+	}
+
+	for (auto stage : { PerformanceProbe::LoCut, PerformanceProbe::Peak, PerformanceProbe::HiCut })
+		if (totals[static_cast<size_t>(stage)] > 0)
+			performanceProbe.record(stage, totals[static_cast<size_t>(stage)], numSamples);
+
+	if (redesignTicks > 0)
+	{
+		performanceProbe.record(PerformanceProbe::Redesign, redesignTicks, numSamples);
+		redesignTicks = 0;
+	}
+}
+
+
+// Runs process on a copy of the block in the scratch buffer's sample type, a scratch buffer at a time.
+template <typename SampleType, typename ScratchType, typename ProcessFunction>
+void Simple_eqAudioProcessor::processConverted(const juce::dsp::AudioBlock<SampleType>& block, juce::AudioBuffer<ScratchType>& scratch, ProcessFunction&& process)
+{
+	const auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(scratch.getNumChannels()));
+	const auto scratchSize = static_cast<size_t>(scratch.getNumSamples());
+
+	for (size_t start = 0; start < block.getNumSamples(); start += scratchSize)
+	{
+		const auto numSamples = juce::jmin(scratchSize, block.getNumSamples() - start);
+
+		for (size_t ch = 0; ch < numChannels; ch++)
+		{
+			const auto* source = block.getChannelPointer(ch) + start;
+			std::transform(source, source + numSamples, scratch.getWritePointer(static_cast<int>(ch)),
+				[](SampleType x) { return static_cast<ScratchType>(x); });
+		}
+
+		process(juce::dsp::AudioBlock<ScratchType>(scratch).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples));
+
+		for (size_t ch = 0; ch < numChannels; ch++)
+		{
+			const auto* source = scratch.getReadPointer(static_cast<int>(ch));
+			std::transform(source, source + numSamples, block.getChannelPointer(ch) + start,
+				[](ScratchType x) { return static_cast<SampleType>(x); });
+		}
+	}
+}
+
+
+template <typename SampleType>
+void Simple_eqAudioProcessor::processChannels(const juce::dsp::AudioBlock<SampleType>& block)
+{
+	const auto numGroups = getNumChannelGroups();
+
+	if (workerPool != nullptr && numGroups > 1)
+	{
+		struct GroupJob
+		{
+			Simple_eqAudioProcessor& processor;
+			const juce::dsp::AudioBlock<SampleType>& block;
+		};
+
+		GroupJob job{ *this, block };
+
+		workerPool->run(numGroups, [](void* context, int group)
+		{
+			auto& j = *static_cast<GroupJob*>(context);
+			j.processor.processChannelGroup(j.block, group);
+		}, &job);
+
+		return;
+	}
+
+	for (int group = 0; group < numGroups; group++)
+		processChannelGroup(block, group);
+}
+
+
+// The scalar chain a stage at a time, the way ProcessorChain::process runs it, adding up each stage's counter ticks
+template <typename ChainType, typename SampleType>
+static void processStagesTimed(ChainType& chain, const juce::dsp::ProcessContextReplacing<SampleType>& context, std::array<juce::uint64, 3>& ticks) noexcept
+{
+	auto processStage = [&](auto position)
+	{
+		constexpr int index = decltype(position)::value;
+
+		auto stageContext = context;
+		stageContext.isBypassed = context.isBypassed || chain.template isBypassed<index>();
+
+		const auto start = PerformanceProbe::now();
+		chain.template get<index>().process(stageContext);
+		ticks[static_cast<size_t>(index)] += PerformanceProbe::now() - start;
+	};
+
+	processStage(std::integral_constant<int, ChainPositions::LoCut>());
+	processStage(std::integral_constant<int, ChainPositions::Peak>());
+	processStage(std::integral_constant<int, ChainPositions::HiCut>());
+}
+
+
+void Simple_eqAudioProcessor::processChannelGroup(const juce::dsp::AudioBlock<float>& block, int group)
+{
+	const auto first = group * channelsPerGroup;
+	const auto numChannels = juce::jmin(channelsPerGroup, juce::jmin(chains.size(), static_cast<int>(block.getNumChannels())) - first);
+
+	if (numChannels <= 0)
+		return;
+
+	auto groupBlock = block.getSubsetChannelBlock(static_cast<size_t>(first), static_cast<size_t>(numChannels));
+	const auto timeStages = performanceProbe.isEnabled();
+
+	// The engine's ramp covers the whole block it was set up for, so it is not split again
+	if (activeBackend == ProcessingBackend::StateVariable)
+	{
+		if (bandEngine.hasActiveBands())
+			bandEngine.process(groupBlock, first);
+
+		stateVariableEngine.process(groupBlock, first, timeStages ? &stageTicks[static_cast<size_t>(group)].ticks : nullptr);
+		return;
+	}
+
+	const auto chunkSize = activeReblocking ? getChunkSize<float>() : groupBlock.getNumSamples();
+
+	for (size_t start = 0; start < groupBlock.getNumSamples(); start += chunkSize)
+	{
+		auto chunk = groupBlock.getSubBlock(start, juce::jmin(chunkSize, groupBlock.getNumSamples() - start));
+
+		if (bandEngine.hasActiveBands())
+			bandEngine.process(chunk, first);
+
+	   #if JUCE_USE_SIMD
+		if (activeBackend == ProcessingBackend::Packed)
+		{
+			packedEngines.getUnchecked(group)->process(chunk, timeStages ? &stageTicks[static_cast<size_t>(group)].ticks : nullptr);
+			continue;
+		}
+	   #endif
+
+		for (int ch = 0; ch < numChannels; ch++)
+		{
+			auto channelBlock = chunk.getSingleChannelBlock(static_cast<size_t>(ch));
+			juce::dsp::ProcessContextReplacing<float> context(channelBlock);
+
+			if (timeStages)
+				processStagesTimed(*chains.getUnchecked(first + ch), context, stageTicks[static_cast<size_t>(group)].ticks);
+			else
+				chains.getUnchecked(first + ch)->process(context);
+		}
+	}
+}
+
+
+// There is no packed double backend; every channel runs its own DoubleMonoChain,
+// or the double state variable engine.
+void Simple_eqAudioProcessor::processChannelGroup(const juce::dsp::AudioBlock<double>& block, int group)
+{
+	const auto first = group * channelsPerGroup;
+	const auto numChannels = juce::jmin(channelsPerGroup, juce::jmin(doubleChains.size(), static_cast<int>(block.getNumChannels())) - first);
+
+	if (numChannels <= 0)
+		return;
+
+	auto groupBlock = block.getSubsetChannelBlock(static_cast<size_t>(first), static_cast<size_t>(numChannels));
+	const auto timeStages = performanceProbe.isEnabled();
+
+	if (activeBackend == ProcessingBackend::StateVariable)
+	{
+		if (doubleBandEngine.hasActiveBands())
+			doubleBandEngine.process(groupBlock, first);
+
+		doubleStateVariableEngine.process(groupBlock, first, timeStages ? &stageTicks[static_cast<size_t>(group)].ticks : nullptr);
+		return;
+	}
+
+	const auto chunkSize = activeReblocking ? getChunkSize<double>() : groupBlock.getNumSamples();
+
+	for (size_t start = 0; start < groupBlock.getNumSamples(); start += chunkSize)
+	{
+		auto chunk = groupBlock.getSubBlock(start, juce::jmin(chunkSize, groupBlock.getNumSamples() - start));
+
+		if (doubleBandEngine.hasActiveBands())
+			doubleBandEngine.process(chunk, first);
+
+		for (int ch = 0; ch < numChannels; ch++)
+		{
+			auto channelBlock = chunk.getSingleChannelBlock(static_cast<size_t>(ch));
+			juce::dsp::ProcessContextReplacing<double> context(channelBlock);
+
+			if (timeStages)
+				processStagesTimed(*doubleChains.getUnchecked(first + ch), context, stageTicks[static_cast<size_t>(group)].ticks);
+			else
+				doubleChains.getUnchecked(first + ch)->process(context);
+		}
+	}
 }
 
 //==============================================================================
@@ -211,8 +783,7 @@ void Simple_eqAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // as intermediaries to make it easy to save and load complex data.
 
 
-	juce::MemoryOutputStream mos(destData, true);
-	apvts.state.writeToStream(mos);
+	writeBinaryState(destData, getParameters(), getStateSettings());
 }
 
 void Simple_eqAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -220,86 +791,463 @@ void Simple_eqAudioProcessor::setStateInformation (const void* data, int sizeInB
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
 
+	StateSettings settings;
+
+	// The binary state sets the parameters directly, without building and replacing a tree
+	if (isBinaryState(data, sizeInBytes))
+	{
+		if (readBinaryState(data, sizeInBytes, getParameters(), settings))
+			applyStateSettings(settings);
+
+		return;
+	}
+
+	// Sessions saved before the binary format hold the state tree
 	auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
 	if (tree.isValid())
 	{
 		apvts.replaceState(tree);
-		updateFilters();
 
+		// Older states have none of these and keep the defaults
+		const auto& state = apvts.state;
+		settings.linearPhaseKernelLength = state.getProperty("LinearPhaseKernelLength", LinearPhaseEngine::defaultKernelLength);
+		settings.linearPhasePartitionSize = state.getProperty("LinearPhasePartitionSize", LinearPhaseEngine::defaultPartitionSize);
+		settings.phaseMode = state.getProperty("PhaseMode", 0);
+		settings.doublePrecisionState = state.getProperty("DoublePrecisionState", false);
+		settings.stateVariableFilters = state.getProperty("StateVariableFilters", false);
+		settings.oversamplingFactor = state.getProperty("OversamplingFactor", 1);
+		settings.oversamplingFilter = state.getProperty("OversamplingFilter", 0);
+
+		applyStateSettings(settings);
 	}
 }
 
 
+StateSettings Simple_eqAudioProcessor::getStateSettings() const
+{
+	StateSettings settings;
+	settings.phaseMode = getPhaseMode() == PhaseMode::Linear ? 1 : 0;
+	settings.linearPhaseKernelLength = getLinearPhaseKernelLength();
+	settings.linearPhasePartitionSize = getLinearPhasePartitionSize();
+	settings.oversamplingFactor = getOversamplingFactor();
+	settings.oversamplingFilter = getOversamplingFilter() == OversamplingFilter::PolyphaseFIR ? 1 : 0;
+	settings.stateVariableFilters = getProcessingBackend() == ProcessingBackend::StateVariable;
+	settings.doublePrecisionState = isDoublePrecisionState();
+
+	return settings;
+}
 
 
-ChainSettings  getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+void Simple_eqAudioProcessor::applyStateSettings(const StateSettings& settings)
 {
-	ChainSettings  settings;
+	setLinearPhaseKernelLength(settings.linearPhaseKernelLength);
+	setLinearPhasePartitionSize(settings.linearPhasePartitionSize);
+	setPhaseMode(settings.phaseMode == 1 ? PhaseMode::Linear : PhaseMode::Minimum);
+	setDoublePrecisionState(settings.doublePrecisionState);
+
+	if (settings.stateVariableFilters)
+		setProcessingBackend(ProcessingBackend::StateVariable);
+	else if (getProcessingBackend() == ProcessingBackend::StateVariable)
+		setProcessingBackend(defaultBackend);
+
+	setOversampling(settings.oversamplingFactor,
+	                settings.oversamplingFilter == 1 ? OversamplingFilter::PolyphaseFIR : OversamplingFilter::PolyphaseIIR);
+}
 
-	settings.hiCutFreq = apvts.getRawParameterValue("HiCut Freq")->load();
-	settings.loCutFreq = apvts.getRawParameterValue("LoCut Freq")->load();
-	//	settings.hiCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HiCut Slope")->load());
-	//	settings.loCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LoCut Slope")->load());
-	settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-	settings.peakGain = apvts.getRawParameterValue("Peak Gain")->load();
-	settings.peakQ = apvts.getRawParameterValue("Peak Q")->load();
-	settings.loCutSlope = apvts.getRawParameterValue("LoCut Slope")->load();
-	settings.hiCutSlope = apvts.getRawParameterValue("HiCut Slope")->load();
 
-	return settings;
+//==============================================================================
+// The phase settings live as properties of the state tree, so they are saved with the parameters.
+void Simple_eqAudioProcessor::setPhaseMode(PhaseMode mode)
+{
+	apvts.state.setProperty("PhaseMode", mode == PhaseMode::Linear ? 1 : 0, nullptr);
+
+	requestedPhaseMode.store(mode);
+	linearPhase.setActive(mode == PhaseMode::Linear);
+	updateLatency();
+}
+
+
+void Simple_eqAudioProcessor::setLinearPhaseKernelLength(int numSamples)
+{
+	numSamples = juce::nextPowerOfTwo(juce::jlimit(1024, 65536, numSamples));
+	apvts.state.setProperty("LinearPhaseKernelLength", numSamples, nullptr);
+
+	if (linearPhaseKernelLength.exchange(numSamples) != numSamples)
+		prepareLinearPhase();
+}
+
+
+void Simple_eqAudioProcessor::setLinearPhasePartitionSize(int numSamples)
+{
+	numSamples = juce::nextPowerOfTwo(juce::jlimit(64, 8192, numSamples));
+	apvts.state.setProperty("LinearPhasePartitionSize", numSamples, nullptr);
+
+	if (linearPhasePartitionSize.exchange(numSamples) != numSamples)
+		prepareLinearPhase();
 }
 
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+// Rebuilds the convolvers outside prepareToPlay. The callback lock keeps processBlock out meanwhile.
+void Simple_eqAudioProcessor::prepareLinearPhase()
 {
-  return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, 
-	  chainSettings.peakFreq, 
-	  chainSettings.peakQ, 
-	  juce::Decibels::decibelsToGain(chainSettings.peakGain));
+	if (getSampleRate() <= 0)
+		return;
+
+	{
+		const juce::ScopedLock sl(getCallbackLock());
+		linearPhase.prepare(getSampleRate(), getBlockSize(), getTotalNumOutputChannels(),
+		                    linearPhaseKernelLength.load(), linearPhasePartitionSize.load());
+		updateTail();
+	}
+
+	updateLatency();
+}
+
+
+void Simple_eqAudioProcessor::setOversampling(int factor, OversamplingFilter filter)
+{
+	const auto order = juce::jlimit(0, maxOversamplingOrder, juce::roundToInt(std::log2(juce::jmax(1, factor))));
+
+	apvts.state.setProperty("OversamplingFactor", 1 << order, nullptr);
+	apvts.state.setProperty("OversamplingFilter", filter == OversamplingFilter::PolyphaseFIR ? 1 : 0, nullptr);
+
+	const auto orderChanged = oversamplingOrder.exchange(order) != order;
+	const auto filterChanged = oversamplingFilter.exchange(filter) != filter;
+
+	if (!(orderChanged || filterChanged))
+		return;
+
+	if (getSampleRate() <= 0)
+		return;
+
+	{
+		const juce::ScopedLock sl(getCallbackLock());
+		prepareFilterChain(getSampleRate(), getBlockSize());
+		updateTail();
+	}
+
+	updateLatency();
+}
+
+
+void Simple_eqAudioProcessor::setProcessingBackend(ProcessingBackend backend)
+{
+	apvts.state.setProperty("StateVariableFilters", backend == ProcessingBackend::StateVariable, nullptr);
+	requestedBackend.store(backend);
+}
+
+
+void Simple_eqAudioProcessor::setDoublePrecisionState(bool shouldUseDoubleState)
+{
+	apvts.state.setProperty("DoublePrecisionState", shouldUseDoubleState, nullptr);
+
+	if (doublePrecisionState.exchange(shouldUseDoubleState) == shouldUseDoubleState || getSampleRate() <= 0)
+		return;
+
+	const juce::ScopedLock sl(getCallbackLock());
+	prepareFilterChain(getSampleRate(), getBlockSize());
+	updateTail();
 }
 
-void Simple_eqAudioProcessor::updatePeakFilter(const ChainSettings chainSettings)
+
+// In samples at the host rate, for the phase mode in use
+void Simple_eqAudioProcessor::updateTail()
 {
-	auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+	if (activePhaseMode == PhaseMode::Linear)
+	{
+		tailSamples = linearPhase.getTailSamples();
+	}
+	else
+	{
+		const auto factor = oversampling != nullptr ? static_cast<double>(oversampling->getOversamplingFactor()) : 1.0;
+
+		// Twice the oversampler's delay is an allowance for the ringing of its half-band filters
+		tailSamples = static_cast<juce::int64>(std::ceil(chainTailSamples / factor))
+		            + (oversampling != nullptr ? 2 * juce::roundToInt(oversampling->getLatencyInSamples()) : 0);
+	}
+
+	const auto sampleRate = getSampleRate();
+	tailSeconds.store(sampleRate > 0 ? static_cast<double>(tailSamples) / sampleRate : 0.0);
+}
 
-	updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-	updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+
+// Linear mode bypasses the oversampler, the minimum-phase chain reports the half-band filters' delay
+void Simple_eqAudioProcessor::updateLatency()
+{
+	if (requestedPhaseMode.load() == PhaseMode::Linear)
+		setLatencySamples(linearPhase.getLatencySamples());
+	else
+		setLatencySamples(oversampling != nullptr ? juce::roundToInt(oversampling->getLatencyInSamples()) : 0);
 }
 
 
-void updateCoefficients(Coefficients &old, const Coefficients &replacements)
+void Simple_eqAudioProcessor::updatePeakFilter(const ChainCoefficients& chainCoefficients)
 {
-	*old = *replacements;
+	// At 0 dB the peak is transparent and is not run at all
+	const auto isIdentity = isIdentitySection(chainCoefficients.peak->getRawCoefficients());
+
+	for (auto* chain : chains)
+	{
+		updateCoefficients(chain->get<ChainPositions::Peak>().coefficients, chainCoefficients.peak);
+
+		// Coming back from identity, the state left over from before means nothing
+		if (chain->isBypassed<ChainPositions::Peak>() && !isIdentity)
+			chain->get<ChainPositions::Peak>().reset();
+
+		chain->setBypassed<ChainPositions::Peak>(isIdentity);
+	}
+
+	for (auto* chain : doubleChains)
+	{
+		auto& peak = chain->get<ChainPositions::Peak>();
+		peak.setStage(0, chainCoefficients.peak);
+		peak.setNumStages(isIdentity ? 0 : 1);
+	}
+
+   #if JUCE_USE_SIMD
+	for (auto* engine : packedEngines)
+		engine->setPeakStage(chainCoefficients.peak);
+   #endif
 }
 
 
-void Simple_eqAudioProcessor::updateLoCutFilters(const ChainSettings& chainSettings)
+void Simple_eqAudioProcessor::updateLoCutFilters(const ChainCoefficients& chainCoefficients)
 {
-	//auto cutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.loCutFreq, getSampleRate(), (chainSettings.loCutSlope + 1) * 2);
-	auto cutCoefficients = makeLoCutFilter(chainSettings, getSampleRate());
-	auto& leftLoCut = leftChain.get<ChainPositions::LoCut>();
-	auto& rightLoCut = rightChain.get<ChainPositions::LoCut>();
-	updateCutFilter(leftLoCut, cutCoefficients, chainSettings.loCutSlope);
-	updateCutFilter(rightLoCut, cutCoefficients, chainSettings.loCutSlope);
+	for (auto* chain : chains)
+		updateCutFilter(chain->get<ChainPositions::LoCut>(), chainCoefficients.loCut, chainCoefficients.loCutSlope);
+	for (auto* chain : doubleChains)
+		updateCutFilter(chain->get<ChainPositions::LoCut>(), chainCoefficients.loCut, chainCoefficients.loCutSlope);
+
+   #if JUCE_USE_SIMD
+	for (auto* engine : packedEngines)
+		engine->setCutStages(ChainPositions::LoCut, chainCoefficients.loCut, chainCoefficients.loCutSlope);
+   #endif
 }
 
 
-void Simple_eqAudioProcessor::updateHiCutFilters(const ChainSettings& chainSettings)
+void Simple_eqAudioProcessor::updateHiCutFilters(const ChainCoefficients& chainCoefficients)
 {
-	//auto hiCutCoefficients = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.hiCutFreq, getSampleRate(), (chainSettings.hiCutSlope + 1) * 2);
-	auto hiCutCoefficients = makeHiCutFilter(chainSettings, getSampleRate());
-	auto& leftHiCut = leftChain.get<ChainPositions::HiCut>();
-	auto& rightHiCut = rightChain.get<ChainPositions::HiCut>();
-	updateCutFilter(leftHiCut, hiCutCoefficients, chainSettings.hiCutSlope);
-	updateCutFilter(rightHiCut, hiCutCoefficients, chainSettings.hiCutSlope);
+	for (auto* chain : chains)
+		updateCutFilter(chain->get<ChainPositions::HiCut>(), chainCoefficients.hiCut, chainCoefficients.hiCutSlope);
+	for (auto* chain : doubleChains)
+		updateCutFilter(chain->get<ChainPositions::HiCut>(), chainCoefficients.hiCut, chainCoefficients.hiCutSlope);
+
+   #if JUCE_USE_SIMD
+	for (auto* engine : packedEngines)
+		engine->setCutStages(ChainPositions::HiCut, chainCoefficients.hiCut, chainCoefficients.hiCutSlope);
+   #endif
 }
 
+// Picks up whatever the designer thread published since the last block.
+// Only pointers are swapped here: no allocation, no locks, no copies,
+// and only for the sections that were actually redesigned.
 void Simple_eqAudioProcessor::updateFilters()
 {
-	auto chainSettings = getChainSettings(apvts);
-	updateLoCutFilters(chainSettings);
-	updatePeakFilter(chainSettings);
-	updateHiCutFilters(chainSettings);
+	auto* chainCoefficients = coefficientPipeline.pull();
+	if (chainCoefficients == nullptr)
+		return;
+
+	auto sectionChanged = [this, chainCoefficients](ChainPositions section)
+	{
+		if (appliedGenerations[section] == chainCoefficients->generations[section])
+			return false;
+
+		appliedGenerations[section] = chainCoefficients->generations[section];
+		return true;
+	};
+
+	// A ramping section is driven by updateSmoothedSections(); once the ramp is over it keeps
+	// the coefficients designed for the final value until the designer publishes something new.
+	// The same goes for the peak while the dynamics drive it. The state variable backend
+	// ramps on its own, so there the biquads just stay current.
+	auto shouldApply = [this](ChainPositions section)
+	{
+		const auto isDriven = sectionRamping[section] || (section == ChainPositions::Peak && dynamicPeakActive);
+		return !isDriven || activeBackend == ProcessingBackend::StateVariable;
+	};
+
+	if (sectionChanged(ChainPositions::LoCut) && shouldApply(ChainPositions::LoCut))
+		updateLoCutFilters(*chainCoefficients);
+	if (sectionChanged(ChainPositions::Peak) && shouldApply(ChainPositions::Peak))
+		updatePeakFilter(*chainCoefficients);
+	if (sectionChanged(ChainPositions::HiCut) && shouldApply(ChainPositions::HiCut))
+		updateHiCutFilters(*chainCoefficients);
+
+	if (chainTailSamples != chainCoefficients->tailSamples)
+	{
+		chainTailSamples = chainCoefficients->tailSamples;
+		updateTail();
+	}
+
+	if (appliedBandsGeneration != chainCoefficients->bandsGeneration)
+	{
+		appliedBandsGeneration = chainCoefficients->bandsGeneration;
+		bandEngine.setBands(chainCoefficients->bands, chainCoefficients->enabledBands);
+		doubleBandEngine.setBands(chainCoefficients->bands, chainCoefficients->enabledBands);
+	}
+}
+
+
+//==============================================================================
+void Simple_eqAudioProcessor::resetSmoothing(double sampleRate)
+{
+	smoothingTargets.refresh();
+	const auto& targets = smoothingTargets.getSettings();
+
+	loCutFreq.reset(sampleRate, smoothingRampSeconds);
+	hiCutFreq.reset(sampleRate, smoothingRampSeconds);
+	peakFreq.reset(sampleRate, smoothingRampSeconds);
+	peakGain.reset(sampleRate, smoothingRampSeconds);
+	peakQ.reset(sampleRate, smoothingRampSeconds);
+
+	loCutFreq.setCurrentAndTargetValue(targets.loCutFreq);
+	hiCutFreq.setCurrentAndTargetValue(targets.hiCutFreq);
+	peakFreq.setCurrentAndTargetValue(targets.peakFreq);
+	peakGain.setCurrentAndTargetValue(targets.peakGain);
+	peakQ.setCurrentAndTargetValue(targets.peakQ);
+
+	sectionRamping = {};
+}
+
+
+void Simple_eqAudioProcessor::updateSmoothingTargets()
+{
+	smoothingTargets.refresh();
+	const auto& targets = smoothingTargets.getSettings();
+
+	loCutFreq.setTargetValue(targets.loCutFreq);
+	hiCutFreq.setTargetValue(targets.hiCutFreq);
+	peakFreq.setTargetValue(targets.peakFreq);
+	peakGain.setTargetValue(targets.peakGain);
+	peakQ.setTargetValue(targets.peakQ);
+
+	sectionRamping[ChainPositions::LoCut] = sectionRamping[ChainPositions::LoCut] || loCutFreq.isSmoothing();
+	sectionRamping[ChainPositions::Peak] = sectionRamping[ChainPositions::Peak]
+		|| peakFreq.isSmoothing() || peakGain.isSmoothing() || peakQ.isSmoothing();
+	sectionRamping[ChainPositions::HiCut] = sectionRamping[ChainPositions::HiCut] || hiCutFreq.isSmoothing();
+}
+
+
+bool Simple_eqAudioProcessor::isAnySectionRamping() const
+{
+	return sectionRamping[ChainPositions::LoCut] || sectionRamping[ChainPositions::Peak] || sectionRamping[ChainPositions::HiCut];
+}
+
+
+// Advances the smoothers by one sub-block and redesigns the ramping sections in place.
+// The last update of a ramp lands exactly on the target, after which the section stops ramping.
+// While the dynamics are on, the peak is redesigned every sub-block with the envelope's gain.
+void Simple_eqAudioProcessor::updateSmoothedSections(int numSamples, int hostSample)
+{
+	const auto startTicks = juce::Time::getHighResolutionTicks();
+	const auto profiling = performanceProbe.isEnabled();
+	const auto probeStart = profiling ? PerformanceProbe::now() : 0;
+	const auto sampleRate = processingSampleRate.load();
+	const auto& targets = smoothingTargets.getSettings();
+	juce::uint64 numUpdates = 0;
+
+	auto designCut = [sampleRate](CutFilter::CoefficientArray& coefficients, bool isHighPass, float frequency, int slope)
+	{
+		designCutFilter([&coefficients](int i) { return coefficients[i]->getRawCoefficients(); },
+		                isHighPass, sampleRate, frequency, getCutFilterOrder(slope));
+	};
+
+	if (sectionRamping[ChainPositions::LoCut])
+	{
+		designCut(rampCoefficients.loCut, true, loCutFreq.skip(numSamples), targets.loCutSlope);
+		rampCoefficients.loCutSlope = targets.loCutSlope;
+		updateLoCutFilters(rampCoefficients);
+
+		sectionRamping[ChainPositions::LoCut] = loCutFreq.isSmoothing();
+		++numUpdates;
+	}
+
+	if (dynamicPeakActive)
+	{
+		dynamicPeak.designSection(rampCoefficients.peak->getRawCoefficients(),
+			peakFreq.skip(numSamples), peakQ.skip(numSamples),
+			peakGain.skip(numSamples) + dynamicPeak.getGainOffset(hostSample));
+		updatePeakFilter(rampCoefficients);
+
+		sectionRamping[ChainPositions::Peak] = false;
+		numDynamicPeakUpdates.fetch_add(1, std::memory_order_relaxed);
+	}
+	else if (sectionRamping[ChainPositions::Peak])
+	{
+		designPeakSection(rampCoefficients.peak->getRawCoefficients(), sampleRate,
+			peakFreq.skip(numSamples), peakQ.skip(numSamples),
+			juce::Decibels::decibelsToGain(peakGain.skip(numSamples)));
+		updatePeakFilter(rampCoefficients);
+
+		sectionRamping[ChainPositions::Peak] = peakFreq.isSmoothing() || peakGain.isSmoothing() || peakQ.isSmoothing();
+		++numUpdates;
+	}
+
+	if (sectionRamping[ChainPositions::HiCut])
+	{
+		designCut(rampCoefficients.hiCut, false, hiCutFreq.skip(numSamples), targets.hiCutSlope);
+		rampCoefficients.hiCutSlope = targets.hiCutSlope;
+		updateHiCutFilters(rampCoefficients);
+
+		sectionRamping[ChainPositions::HiCut] = hiCutFreq.isSmoothing();
+		++numUpdates;
+	}
+
+	numSmoothedUpdates.fetch_add(numUpdates, std::memory_order_relaxed);
+	smoothingTicks.fetch_add(static_cast<juce::uint64>(juce::Time::getHighResolutionTicks() - startTicks), std::memory_order_relaxed);
+
+	if (profiling)
+		redesignTicks += PerformanceProbe::now() - probeStart;
+}
+
+
+// The state variable engine takes the smoothers' values at both ends of the chunk and
+// follows the same curves in between, recomputing g every sample instead of every sub-block.
+// The dynamic peak's gain offset ramps along with Peak Gain.
+template <typename SampleType>
+void Simple_eqAudioProcessor::rampStateVariableEngine(StateVariableEngine<SampleType>& engine, int numSamples, int hostSample)
+{
+	const auto& targets = smoothingTargets.getSettings();
+
+	auto from = targets;
+	from.loCutFreq = loCutFreq.getCurrentValue();
+	from.hiCutFreq = hiCutFreq.getCurrentValue();
+	from.peakFreq = peakFreq.getCurrentValue();
+	from.peakGain = peakGain.getCurrentValue() + appliedPeakGainOffset;
+	from.peakQ = peakQ.getCurrentValue();
+
+	auto to = targets;
+	to.loCutFreq = loCutFreq.skip(numSamples);
+	to.hiCutFreq = hiCutFreq.skip(numSamples);
+	to.peakFreq = peakFreq.skip(numSamples);
+	appliedPeakGainOffset = dynamicPeakActive ? dynamicPeak.getGainOffset(hostSample) : 0.f;
+	to.peakGain = peakGain.skip(numSamples) + appliedPeakGainOffset;
+	to.peakQ = peakQ.skip(numSamples);
+
+	engine.setRamp(from, to, numSamples);
+
+	if (dynamicPeakActive)
+		numDynamicPeakUpdates.fetch_add(1, std::memory_order_relaxed);
+
+	sectionRamping[ChainPositions::LoCut] = loCutFreq.isSmoothing();
+	sectionRamping[ChainPositions::Peak] = peakFreq.isSmoothing() || peakGain.isSmoothing() || peakQ.isSmoothing();
+	sectionRamping[ChainPositions::HiCut] = hiCutFreq.isSmoothing();
+}
+
+
+Simple_eqAudioProcessor::SmoothingStats Simple_eqAudioProcessor::getSmoothingStats() const
+{
+	return { numSmoothedUpdates.load(),
+	         juce::Time::highResolutionTicksToSeconds(static_cast<juce::int64>(smoothingTicks.load())) };
+}
+
+
+Simple_eqAudioProcessor::DynamicPeakStats Simple_eqAudioProcessor::getDynamicPeakStats() const
+{
+	const auto numUpdates = numDynamicPeakUpdates.load();
+	const auto seconds = getSampleRate() > 0 ? static_cast<double>(dynamicPeakSamples.load()) / getSampleRate() : 0.0;
+
+	return { numUpdates, seconds > 0 ? static_cast<double>(numUpdates) / seconds : 0.0 };
 }
 
 
@@ -329,16 +1277,19 @@ juce::AudioProcessorValueTreeState::ParameterLayout Simple_eqAudioProcessor::cre
 														   1.f));
 
 	juce::StringArray stringArray;
-	for (int i = 0; i < 4; i++)
+	for (auto slope : { 12, 24, 36, 48, 72, 96 })
 	{
 		juce::String str;
-		str << (12 + i * 12)<<" dB/Oct";
+		str << slope <<" dB/Oct";
 		stringArray.add(str);
 	}
 
 	layout.add(std::make_unique<juce::AudioParameterChoice>("LoCut Slope", "LoCut Slope", stringArray, 0));
 	layout.add(std::make_unique<juce::AudioParameterChoice>("HiCut Slope", "HiCut Slope", stringArray, 0));
 
+	addDynamicPeakParameters(layout);
+	addBandParameters(layout);
+
 	return layout;
 }
 
@@ -9,93 +9,41 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-
-enum Slope
+#include "FilterChain.h"
+#include "CoefficientPipeline.h"
+#include "PackedBiquadEngine.h"
+#include "ChannelWorkerPool.h"
+#include "CoefficientDesign.h"
+#include "AnalyserFifo.h"
+#include "ParametricBands.h"
+#include "ParametricBandEngine.h"
+#include "LinearPhaseEngine.h"
+#include "StateVariableEngine.h"
+#include "DynamicPeak.h"
+#include "PerformanceProbe.h"
+#include "BinaryState.h"
+
+
+enum class ProcessingBackend
 {
-	Slope_12,
-	Slope_24,
-	Slope_36,
-	Slope_48
+	Packed,          // PackedBiquadEngine, all channels of a group in one SIMD pass
+	Scalar,          // one MonoChain per channel
+	StateVariable    // StateVariableEngine, TPT filters that follow the smoothers sample by sample
 };
 
 
-struct ChainSettings
+enum class OversamplingFilter
 {
-	float peakFreq{ 0 }, peakGain{ 0 }, peakQ{ 1.f };
-	float loCutFreq{ 0 }, hiCutFreq{ 0 };
-	int loCutSlope{ Slope::Slope_12 }, hiCutSlope{ Slope::Slope_12 };
+	PolyphaseIIR,   // minimum phase, a few samples of latency
+	PolyphaseFIR    // linear phase, more latency
 };
 
 
-ChainSettings  getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-
-using Filter = juce::dsp::IIR::Filter<float>;
-
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-
-enum ChainPositions
+enum class PhaseMode
 {
-	LoCut,
-	Peak,
-	HiCut
-	};
-
-
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients &old, const Coefficients &replacements);
-
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
-
-
-
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, CoefficientType& coefficients)
-{
-	updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-	chain.template setBypassed<Index>(false);
-}
-
-
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& leftLoCut, const CoefficientType&  cutCoefficients, const int loCutSlope)    //const ChainSettings& chainSettings)
-{
-
-	leftLoCut.template setBypassed<0>(true);
-	leftLoCut.template setBypassed<1>(true);
-	leftLoCut.template setBypassed<2>(true);
-	leftLoCut.template setBypassed<3>(true);
-
-	switch (loCutSlope)
-	{
-	case Slope_48:
-		update<3>(leftLoCut, cutCoefficients);
-	case Slope_36:
-		update<2>(leftLoCut, cutCoefficients);
-	case Slope_24:
-		update<1>(leftLoCut, cutCoefficients);
-	case Slope_12:
-		update<0>(leftLoCut, cutCoefficients);
-	}
-
-}
-
-
-inline auto makeLoCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-	return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.loCutFreq, 
-		sampleRate, 
-		(chainSettings.loCutSlope + 1) * 2);
-}
-
-inline auto makeHiCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-	return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.hiCutFreq,
-		sampleRate,
-		(chainSettings.hiCutSlope + 1) * 2);
-}
+	Minimum,   // the IIR chain, no latency
+	Linear     // LinearPhaseEngine, half a kernel of latency
+};
 
 
 //==============================================================================
@@ -120,6 +68,9 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -147,21 +98,256 @@ public:
 	static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 	juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Parameters", createParameterLayout()};  // AudioProcessor &processorToConnectTo, UndoManager *undoManagerToUse, const Identifier &ValueTreeType,  ParameterLayout parameterLayout }; 
 
+	// Tracks which of the parametric bands changed, for the designer thread and the editor.
+	BandParameters bandParameters{ apvts };
+
+	// Input and output of every block, for the editor's spectrum analyser. Only fed while it reads them.
+	AnalyserFifo preEqAnalyserFifo, postEqAnalyserFifo;
+
+	// Designer-thread counters: in steady state only the skipped count moves.
+	juce::uint64 getNumCoefficientRedesigns() const { return coefficientPipeline.getNumRedesigns(); }
+	juce::uint64 getNumSkippedRedesigns() const { return coefficientPipeline.getNumSkippedRedesigns(); }
+
+	// Hits and misses of the design cache all instances in the process share
+	CoefficientCache::Stats getCoefficientCacheStats() const { return coefficientPipeline.getCacheStats(); }
+
+   #if JUCE_USE_SIMD
+	static constexpr ProcessingBackend defaultBackend = ProcessingBackend::Packed;
+   #else
+	static constexpr ProcessingBackend defaultBackend = ProcessingBackend::Scalar;
+   #endif
+
+	// Takes effect at the start of the next block. Whether the state variable
+	// backend is in use is saved with the state.
+	void setProcessingBackend(ProcessingBackend backend);
+	ProcessingBackend getProcessingBackend() const { return requestedBackend.load(); }
+
+	// Spreads the channel groups of wide layouts over a few worker threads.
+	// The workers are created in prepareToPlay, so this takes effect on the next one.
+	void setParallelChannelProcessing(bool shouldBeParallel) { parallelChannelProcessing.store(shouldBeParallel); }
+
+	// While a section's parameters ramp, it is redesigned on the audio thread once per
+	// sub-block of this many samples, independent of the host block size.
+	void setSmoothingSubBlockSize(int numSamples) { smoothingSubBlockSize.store(juce::jlimit(1, 4096, numSamples)); }
+	int getSmoothingSubBlockSize() const { return smoothingSubBlockSize.load(); }
+
+	// Filters long blocks in cache-sized chunks and lets blocks of a few samples skip the
+	// per-block work between control updates. On by default; switching it off is for measuring.
+	void setReblocking(bool shouldReblock) { reblocking.store(shouldReblock); }
+
+	struct SmoothingStats
+	{
+		juce::uint64 numSectionUpdates;   // sections redesigned on the audio thread
+		double secondsSpent;              // time spent in those redesigns
+	};
+
+	SmoothingStats getSmoothingStats() const;
+
+	struct DynamicPeakStats
+	{
+		juce::uint64 numGainUpdates;   // peak redesigns driven by the envelope follower
+		double updatesPerSecond;       // per second of audio processed with the dynamics on
+	};
+
+	DynamicPeakStats getDynamicPeakStats() const;
+
+	// Message thread. Linear mode runs the whole EQ as one FIR kernel and reports its delay to the host.
+	void setPhaseMode(PhaseMode mode);
+	PhaseMode getPhaseMode() const { return requestedPhaseMode.load(); }
+
+	// Message thread. Both rebuild the convolvers, so expect a short gap in the output.
+	void setLinearPhaseKernelLength(int numSamples);
+	int getLinearPhaseKernelLength() const { return linearPhaseKernelLength.load(); }
+	void setLinearPhasePartitionSize(int numSamples);
+	int getLinearPhasePartitionSize() const { return linearPhasePartitionSize.load(); }
+
+	// Message thread. Runs the minimum-phase chain at 1, 2, 4 or 8 times the host rate through
+	// polyphase half-band filters. Rebuilds the chains, so expect a short gap in the output.
+	void setOversampling(int factor, OversamplingFilter filter);
+	int getOversamplingFactor() const { return 1 << oversamplingOrder.load(); }
+	OversamplingFilter getOversamplingFilter() const { return oversamplingFilter.load(); }
+
+	// Message thread. Keeps float I/O but runs the IIR chain with double state, which the float
+	// biquads need for very low LoCut frequencies. Has no effect when the host already sends doubles.
+	void setDoublePrecisionState(bool shouldUseDoubleState);
+	bool isDoublePrecisionState() const { return doublePrecisionState.load(); }
+
+	// The rate the IIR coefficients are designed for: the host rate times the oversampling factor
+	double getProcessingSampleRate() const { return processingSampleRate.load(); }
+
+	// Timings of processBlock and its stages. Does nothing unless built with SIMPLE_EQ_PROFILING=1.
+	PerformanceProbe& getPerformanceProbe() { return performanceProbe; }
+
 private:
+	// Before everything it times, so it outlives the designer thread
+	PerformanceProbe performanceProbe;
+
+	// Counter ticks of the LoCut, Peak and HiCut stages, per channel group so the workers never share a line
+	struct alignas(64) GroupStageTicks
+	{
+		std::array<juce::uint64, 3> ticks{};
+	};
+
+	std::vector<GroupStageTicks> stageTicks;
+	juce::uint64 redesignTicks = 0;
+
+	void recordStageTimes(int numSamples);
+
+	// The settings a state holds besides the parameters, whichever format it came in
+	StateSettings getStateSettings() const;
+	void applyStateSettings(const StateSettings& settings);
+
+	juce::OwnedArray<MonoChain> chains;   // one per channel, allocated in prepareToPlay
+
+   #if JUCE_USE_SIMD
+	static constexpr int channelsPerGroup = PackedBiquadEngine::numLanes;
+   #else
+	static constexpr int channelsPerGroup = 4;
+   #endif
 
-	MonoChain leftChain, rightChain;
+	int getNumChannelGroups() const { return (chains.size() + channelsPerGroup - 1) / channelsPerGroup; }
+	void processChannelGroup(const juce::dsp::AudioBlock<float>& block, int group);
+	void processChannelGroup(const juce::dsp::AudioBlock<double>& block, int group);
 
-	void updatePeakFilter(const ChainSettings chainSettings);
+	// Each group runs a long block a chunk at a time, so the chunk stays in the L1 cache while
+	// every stage passes over it. A whole number of 16 samples keeps each chunk SIMD aligned.
+	static constexpr size_t chunkBytes = 16 * 1024;
 
+	template <typename SampleType>
+	static constexpr size_t getChunkSize() { return juce::jmax(static_cast<size_t>(16), chunkBytes / (channelsPerGroup * sizeof(SampleType)) / 16 * 16); }
 
+	std::atomic<bool> reblocking{ true };
+	bool activeReblocking = true;   // read once per control update
 
+	std::atomic<bool> parallelChannelProcessing{ false };
+	std::unique_ptr<ChannelWorkerPool> workerPool;
 
+   #if JUCE_USE_SIMD
+	juce::OwnedArray<PackedBiquadEngine> packedEngines;   // one per group of PackedBiquadEngine::numLanes channels
+   #endif
+
+	std::atomic<ProcessingBackend> requestedBackend{ defaultBackend };
+	ProcessingBackend activeBackend{ requestedBackend.load() };
+
+	CoefficientPipeline coefficientPipeline{ apvts, bandParameters, &performanceProbe };
+	std::array<juce::uint32, 3> appliedGenerations{};
 
-	void updateLoCutFilters(const ChainSettings& chainSettings);
-	void updateHiCutFilters(const ChainSettings& chainSettings);
+	StateVariableEngine<float> stateVariableEngine;   // all channels, like the band engine
+
+	ParametricBandEngine<float> bandEngine;    // all channels, each group processes its own
+	juce::uint32 appliedBandsGeneration = 0;
+
+	void updatePeakFilter(const ChainCoefficients& chainCoefficients);
+	void updateLoCutFilters(const ChainCoefficients& chainCoefficients);
+	void updateHiCutFilters(const ChainCoefficients& chainCoefficients);
 
 	void updateFilters();
 
+	void beginBlock();
+	void resetFilterState();
+
+	template <typename SampleType>
+	void processFilterChain(juce::dsp::AudioBlock<SampleType> block, juce::dsp::Oversampling<SampleType>* oversampler);
+
+	template <typename SampleType>
+	void processChannels(const juce::dsp::AudioBlock<SampleType>& block);
+
+	template <typename SampleType, typename ScratchType, typename ProcessFunction>
+	static void processConverted(const juce::dsp::AudioBlock<SampleType>& block, juce::AudioBuffer<ScratchType>& scratch, ProcessFunction&& process);
+
+	//==============================================================================
+	LinearPhaseEngine linearPhase{ apvts, bandParameters };
+
+	std::atomic<PhaseMode> requestedPhaseMode{ PhaseMode::Minimum };
+	PhaseMode activePhaseMode{ PhaseMode::Minimum };
+
+	std::atomic<int> linearPhaseKernelLength{ LinearPhaseEngine::defaultKernelLength };
+	std::atomic<int> linearPhasePartitionSize{ LinearPhaseEngine::defaultPartitionSize };
+
+	void prepareLinearPhase();
+	void updateLatency();
+
+	//==============================================================================
+	static constexpr int maxOversamplingOrder = 3;
+
+	std::unique_ptr<juce::dsp::Oversampling<float>> oversampling;   // nullptr when not oversampling
+	std::atomic<int> oversamplingOrder{ 0 };
+	std::atomic<OversamplingFilter> oversamplingFilter{ OversamplingFilter::PolyphaseIIR };
+	std::atomic<double> processingSampleRate{ 0 };
+
+	void prepareFilterChain(double hostSampleRate, int hostBlockSize);
+
+	//==============================================================================
+	static constexpr float silenceThreshold = 1.0e-8f;   // -160 dBFS
+
+	double chainTailSamples = 0;       // at the processing rate, from the published coefficients
+	juce::int64 tailSamples = 0;       // at the host rate, for the active phase mode
+	juce::int64 silentSamples = 0;
+	bool skippingSilence = false;
+	std::atomic<double> tailSeconds{ 0 };
+
+	void updateTail();
+
+	template <typename SampleType>
+	bool canSkipBlock(const juce::dsp::AudioBlock<SampleType>& block);
+
+	//==============================================================================
+	// Blocks of at most tinyBlockSize samples skip beginBlock() and the rest of the per-block
+	// work until controlInterval samples have gone by, so parameter and mode changes reach
+	// them at most that late. Only the plain minimum-phase chain at the host rate takes this path.
+	static constexpr int tinyBlockSize = 32;
+	static constexpr int controlInterval = 64;
+
+	int samplesSinceControlUpdate = 0;
+
+	template <typename SampleType>
+	bool processTinyBlock(juce::AudioBuffer<SampleType>& mainBuffer, bool hasOversampling);
+
+	//==============================================================================
+	// Double precision: allocated in prepareFilterChain only when something runs them
+	juce::OwnedArray<DoubleMonoChain> doubleChains;
+	ParametricBandEngine<double> doubleBandEngine;
+	StateVariableEngine<double> doubleStateVariableEngine;
+	std::unique_ptr<juce::dsp::Oversampling<double>> doubleOversampling;
+
+	std::atomic<bool> doublePrecisionState{ false };
+	bool useDoubleState = false;
+
+	juce::AudioBuffer<double> doubleScratch;   // float I/O with double state
+	juce::AudioBuffer<float> floatScratch;     // double I/O through the float-only convolver
+
+	//==============================================================================
+	static constexpr double smoothingRampSeconds = 0.05;
+
+	ParameterSnapshot smoothingTargets{ apvts };   // audio thread copy, separate from the designer's
+
+	juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> loCutFreq, hiCutFreq, peakFreq, peakQ;
+	juce::SmoothedValue<float> peakGain;
+
+	ChainCoefficients rampCoefficients;   // preallocated, redesigned in place while ramping
+	std::array<bool, 3> sectionRamping{};
+
+	std::atomic<int> smoothingSubBlockSize{ 32 };
+	std::atomic<juce::uint64> numSmoothedUpdates{ 0 }, smoothingTicks{ 0 };
+
+	void resetSmoothing(double sampleRate);
+	void updateSmoothingTargets();
+	bool isAnySectionRamping() const;
+	void updateSmoothedSections(int numSamples, int hostSample);
+
+	template <typename SampleType>
+	void rampStateVariableEngine(StateVariableEngine<SampleType>& engine, int numSamples, int hostSample);
+
+	//==============================================================================
+	DynamicPeak dynamicPeak{ apvts };
+	bool dynamicPeakActive = false;
+	float appliedPeakGainOffset = 0;   // what the state variable engine's peak last ramped to
+
+	std::atomic<juce::uint64> numDynamicPeakUpdates{ 0 }, dynamicPeakSamples{ 0 };
+
+	template <typename SampleType>
+	void updateDynamicPeak(juce::AudioBuffer<SampleType>& buffer);
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Simple_eqAudioProcessor)
 };
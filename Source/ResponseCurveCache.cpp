@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    ResponseCurveCache.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseCurveCache.h"
+
+
+void ResponseCurveCache::setFrequencies(int newNumPoints, double sampleRate)
+{
+	numPoints = juce::jmax(0, newNumPoints);
+	currentSampleRate = sampleRate;
+
+	phi.resize(static_cast<size_t>(numPoints));
+	product.resize(static_cast<size_t>(numPoints));
+	decibels.resize(static_cast<size_t>(numPoints));
+
+	for (int i = 0; i < numPoints; i++)
+	{
+		const auto frequency = juce::mapToLog10(static_cast<double>(i) / numPoints, 20.0, 20000.0);
+		const auto halfOmega = juce::MathConstants<double>::pi * juce::jmin(frequency, sampleRate * 0.5) / sampleRate;
+		const auto s = std::sin(halfOmega);
+
+		phi[static_cast<size_t>(i)] = s * s;
+	}
+
+	for (auto& stage : stages)
+	{
+		stage.magnitudesSquared.resize(static_cast<size_t>(numPoints));
+		stage.valid = false;
+	}
+
+	curveValid = false;
+}
+
+
+void ResponseCurveCache::setChain(const ChainCoefficients& chainCoefficients)
+{
+	auto raw = [](const Coefficients& coefficients) -> const float*
+	{
+		if (coefficients == nullptr)
+			return nullptr;
+
+		jassert(coefficients->getFilterOrder() == 2);
+		return coefficients->getRawCoefficients();
+	};
+
+	setStage(0, raw(chainCoefficients.peak));
+
+	const auto numLoCutStages = getCutFilterNumStages(chainCoefficients.loCutSlope);
+	const auto numHiCutStages = getCutFilterNumStages(chainCoefficients.hiCutSlope);
+
+	for (int i = 0; i < CutFilter::maxStages; i++)
+	{
+		setStage(1 + i, i < numLoCutStages ? raw(chainCoefficients.loCut[i]) : nullptr);
+		setStage(1 + CutFilter::maxStages + i, i < numHiCutStages ? raw(chainCoefficients.hiCut[i]) : nullptr);
+	}
+
+	for (int band = 0; band < maxParametricBands; band++)
+	{
+		const auto enabled = (chainCoefficients.enabledBands & (1u << band)) != 0;
+		setStage(1 + 2 * CutFilter::maxStages + band, enabled ? chainCoefficients.bands[static_cast<size_t>(band)].data() : nullptr);
+	}
+}
+
+
+void ResponseCurveCache::setStage(int index, const float* raw)
+{
+	auto& stage = stages[static_cast<size_t>(index)];
+
+	if (raw == nullptr)
+	{
+		if (stage.active)
+			curveValid = false;
+
+		stage.active = false;
+		return;
+	}
+
+	if (!stage.active || !std::equal(stage.coefficients.begin(), stage.coefficients.end(), raw))
+	{
+		std::copy_n(raw, stage.coefficients.size(), stage.coefficients.begin());
+		stage.valid = false;
+		curveValid = false;
+	}
+
+	stage.active = true;
+}
+
+
+bool ResponseCurveCache::update()
+{
+	if (curveValid || numPoints == 0 || currentSampleRate <= 0)
+		return false;
+
+	std::fill(product.begin(), product.end(), 1.0);
+
+	for (auto& stage : stages)
+	{
+		if (!stage.active)
+			continue;
+
+		if (!stage.valid)
+			evaluateStage(stage);
+
+		const auto* m = stage.magnitudesSquared.data();
+		for (int i = 0; i < numPoints; i++)
+			product[static_cast<size_t>(i)] *= m[i];
+	}
+
+	// Anything below -300 dB is off the plot anyway; the floor also keeps log10 away from 0
+	for (int i = 0; i < numPoints; i++)
+		decibels[static_cast<size_t>(i)] = static_cast<float>(10.0 * std::log10(juce::jmax(product[static_cast<size_t>(i)], 1.0e-30)));
+
+	curveValid = true;
+	return true;
+}
+
+
+void ResponseCurveCache::evaluateStage(Stage& stage)
+{
+	evaluateSectionMagnitudesSquared(stage.coefficients.data(), phi.data(), stage.magnitudesSquared.data(), numPoints);
+	stage.valid = true;
+}
+
+
+void evaluateSectionMagnitudesSquared(const float* c, const double* phi, double* out, int numPoints) noexcept
+{
+	const double b0 = c[0], b1 = c[1], b2 = c[2];
+	const double a1 = c[3], a2 = c[4];
+
+	const auto bSum = b0 + b1 + b2;
+	const auto aSum = 1.0 + a1 + a2;
+
+	const auto n0 = bSum * bSum, n1 = -4.0 * (b0 * b1 + 4.0 * b0 * b2 + b1 * b2), n2 = 16.0 * b0 * b2;
+	const auto d0 = aSum * aSum, d1 = -4.0 * (a1 + 4.0 * a2 + a1 * a2), d2 = 16.0 * a2;
+
+	for (int i = 0; i < numPoints; i++)
+	{
+		const auto numerator = n0 + (n1 + n2 * phi[i]) * phi[i];
+		const auto denominator = d0 + (d1 + d2 * phi[i]) * phi[i];
+
+		out[i] = numerator / denominator;
+	}
+}
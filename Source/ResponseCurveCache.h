@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    ResponseCurveCache.h
+
+    Magnitude response of the whole chain at one point per pixel column, for
+    the editor's response curve.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientPipeline.h"
+
+
+// Writes |H|^2 of the normalised section { b0, b1, b2, a1, a2 } at each phi[i] = sin^2(w_i / 2) into out.
+void evaluateSectionMagnitudesSquared(const float* coefficients, const double* phi, double* out, int numPoints) noexcept;
+
+
+/**
+	Keeps the squared magnitude of every second order section at a fixed table of
+	frequencies, laid out once per resize. When the chain changes, only the sections
+	whose coefficients differ from last time are evaluated again, and the curve is the
+	product of the cached sections.
+
+	A section is evaluated in terms of phi = sin^2(w / 2):
+
+		|H|^2 = ((b0 + b1 + b2)^2 - 4 (b0 b1 + 4 b0 b2 + b1 b2) phi + 16 b0 b2 phi^2)
+		      / ((1 + a1 + a2)^2 - 4 (a1 + 4 a2 + a1 a2) phi + 16 a2 phi^2)
+
+	which is a straight polynomial over the phi table (so it vectorises) and stays
+	accurate near DC and Nyquist, where the cos(w) form cancels.
+*/
+class ResponseCurveCache
+{
+public:
+	static constexpr int maxStages = 1 + 2 * CutFilter::maxStages + maxParametricBands;
+
+	// Lays out numPoints log-spaced frequencies from 20 Hz to 20 kHz and invalidates every section.
+	void setFrequencies(int numPoints, double sampleRate);
+
+	int getNumPoints() const { return numPoints; }
+	double getSampleRate() const { return currentSampleRate; }
+
+	void setChain(const ChainCoefficients& chainCoefficients);
+
+	// Evaluates whatever changed since the last call. Returns false if the curve is unchanged.
+	bool update();
+
+	// In dB, one value per point
+	const std::vector<float>& getDecibels() const { return decibels; }
+
+private:
+	struct Stage
+	{
+		std::array<float, 5> coefficients{};   // b0, b1, b2, a1, a2
+		bool active = false;
+		bool valid = false;
+		std::vector<double> magnitudesSquared;
+	};
+
+	// nullptr for a section that is not in use
+	void setStage(int index, const float* coefficients);
+	void evaluateStage(Stage& stage);
+
+	std::array<Stage, maxStages> stages;
+
+	std::vector<double> phi;
+	std::vector<double> product;
+	std::vector<float> decibels;
+
+	int numPoints = 0;
+	double currentSampleRate = 0;
+	bool curveValid = false;
+};
@@ -0,0 +1,261 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyser.h"
+
+
+SpectrumAnalyser::SpectrumAnalyser(AnalyserFifo& preEqFifo, AnalyserFifo& postEqFifo)
+	: juce::Thread("Simple_eq spectrum analyser")
+{
+	analyses[PreEq] = std::make_unique<Analysis>(preEqFifo);
+	analyses[PostEq] = std::make_unique<Analysis>(postEqFifo);
+
+	for (int source = 0; source < numSources; source++)
+		setSourceEnabled(static_cast<Source>(source), true);
+
+	startThread(juce::Thread::Priority::low);
+}
+
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+	for (auto& analysis : analyses)
+		analysis->fifo.setActive(false);
+
+	stopThread(1000);
+}
+
+
+void SpectrumAnalyser::setFftOrder(int order)
+{
+	fftOrder.store(juce::jlimit(minFftOrder, maxFftOrder, order));
+}
+
+
+void SpectrumAnalyser::setAveragingFrames(int numFrames)
+{
+	averagingFrames.store(juce::jlimit(1, 128, numFrames));
+}
+
+
+void SpectrumAnalyser::setSourceEnabled(Source source, bool shouldBeEnabled)
+{
+	sourceEnabled[source].store(shouldBeEnabled);
+	analyses[source]->fifo.setActive(shouldBeEnabled && !paused.load());
+}
+
+
+void SpectrumAnalyser::setPaused(bool shouldBePaused)
+{
+	if (paused.exchange(shouldBePaused) == shouldBePaused)
+		return;
+
+	for (int source = 0; source < numSources; source++)
+		analyses[source]->fifo.setActive(isSourceEnabled(static_cast<Source>(source)) && !shouldBePaused);
+}
+
+
+bool SpectrumAnalyser::isSourceEnabled(Source source) const
+{
+	return sourceEnabled[source].load();
+}
+
+
+void SpectrumAnalyser::setPlotBounds(juce::Rectangle<float> bounds)
+{
+	const juce::ScopedLock sl(pathLock);
+	plotBounds = bounds;
+}
+
+
+void SpectrumAnalyser::strokePath(juce::Graphics& g, Source source, const juce::PathStrokeType& strokeType)
+{
+	if (!isSourceEnabled(source))
+		return;
+
+	const juce::ScopedLock sl(pathLock);
+	g.strokePath(analyses[source]->path, strokeType);
+}
+
+
+void SpectrumAnalyser::run()
+{
+	while (!threadShouldExit())
+	{
+		applySettings();
+
+		bool anyNewFrames = false;
+
+		for (int source = 0; source < numSources; source++)
+		{
+			auto& analysis = *analyses[source];
+			const auto enabled = isSourceEnabled(static_cast<Source>(source)) && !paused.load();
+
+			// Start afresh rather than with whatever was left over from before it was hidden or paused
+			if (enabled && !analysis.wasEnabled)
+			{
+				analysis.fifo.discardAll();
+				analysis.numPending = 0;
+				analysis.hasAverage = false;
+			}
+
+			analysis.wasEnabled = enabled;
+
+			if (enabled && analyse(analysis))
+				anyNewFrames = true;
+		}
+
+		if (anyNewFrames)
+		{
+			juce::Rectangle<float> bounds;
+			{
+				const juce::ScopedLock sl(pathLock);
+				bounds = plotBounds;
+			}
+
+			for (auto& analysis : analyses)
+			{
+				if (!analysis->wasEnabled || !analysis->hasAverage)
+					continue;
+
+				buildPath(*analysis, bounds);
+
+				const juce::ScopedLock sl(pathLock);
+				analysis->path.swapWithPath(analysis->workPath);
+			}
+
+			newPaths.store(true);
+		}
+
+		wait(pollIntervalMs);
+	}
+}
+
+
+void SpectrumAnalyser::applySettings()
+{
+	const auto order = fftOrder.load();
+	if (fft != nullptr && fft->getSize() == 1 << order)
+		return;
+
+	fft = std::make_unique<juce::dsp::FFT>(order);
+	fftSize = fft->getSize();
+	window = std::make_unique<juce::dsp::WindowingFunction<float>>(static_cast<size_t>(fftSize),
+		juce::dsp::WindowingFunction<float>::hann);
+
+	for (auto& analysis : analyses)
+	{
+		analysis->history.assign(static_cast<size_t>(fftSize), 0.f);
+		analysis->hop.assign(static_cast<size_t>(fftSize / 2), 0.f);
+		analysis->numPending = 0;
+		analysis->fftData.assign(static_cast<size_t>(fftSize * 2), 0.f);
+		analysis->averageDecibels.assign(static_cast<size_t>(fftSize / 2 + 1), minDecibels);
+		analysis->hasAverage = false;
+	}
+}
+
+
+// Pulls everything the audio thread pushed and runs one frame per hop. Returns true if any frame ran.
+bool SpectrumAnalyser::analyse(Analysis& analysis)
+{
+	const auto hopSize = fftSize / 2;
+	bool anyFrame = false;
+
+	for (;;)
+	{
+		analysis.numPending += analysis.fifo.pop(analysis.hop.data() + analysis.numPending, hopSize - analysis.numPending);
+		if (analysis.numPending < hopSize)
+			return anyFrame;
+
+		std::copy(analysis.history.begin() + hopSize, analysis.history.end(), analysis.history.begin());
+		std::copy(analysis.hop.begin(), analysis.hop.end(), analysis.history.end() - hopSize);
+		analysis.numPending = 0;
+
+		performFrame(analysis);
+		anyFrame = true;
+	}
+}
+
+
+void SpectrumAnalyser::performFrame(Analysis& analysis)
+{
+	auto* data = analysis.fftData.data();
+
+	std::copy(analysis.history.begin(), analysis.history.end(), data);
+	std::fill(data + fftSize, data + fftSize * 2, 0.f);
+
+	window->multiplyWithWindowingTable(data, static_cast<size_t>(fftSize));
+	fft->performFrequencyOnlyForwardTransform(data);
+
+	// The window is normalised to unity gain, so a full scale sine ends up at 0 dB
+	const auto scale = 2.f / static_cast<float>(fftSize);
+	const auto alpha = 1.f / static_cast<float>(averagingFrames.load());
+
+	for (size_t bin = 0; bin < analysis.averageDecibels.size(); bin++)
+	{
+		const auto level = juce::Decibels::gainToDecibels(data[bin] * scale, minDecibels);
+		auto& average = analysis.averageDecibels[bin];
+
+		average = analysis.hasAverage ? average + (level - average) * alpha : level;
+	}
+
+	analysis.hasAverage = true;
+}
+
+
+void SpectrumAnalyser::buildPath(Analysis& analysis, juce::Rectangle<float> bounds)
+{
+	auto& path = analysis.workPath;
+	path.clear();
+
+	const auto width = static_cast<int>(bounds.getWidth());
+	if (width <= 0 || bounds.getHeight() <= 0)
+		return;
+
+	const auto& levels = analysis.averageDecibels;
+	const auto lastBin = static_cast<int>(levels.size()) - 1;
+	const auto binsPerHz = fftSize / analysis.fifo.getSampleRate();
+
+	auto binAt = [binsPerHz, width](int column)
+	{
+		return binsPerHz * juce::mapToLog10(static_cast<double>(column) / width, 20.0, 20000.0);
+	};
+
+	for (int x = 0; x < width; x++)
+	{
+		const auto firstBin = binAt(x);
+		const auto endBin = binAt(x + 1);
+
+		float level;
+
+		if (endBin - firstBin < 1.0)
+		{
+			// Fewer than one bin per column at the low end: interpolate
+			const auto position = juce::jlimit(0.0, static_cast<double>(lastBin), (firstBin + endBin) * 0.5);
+			const auto index = juce::jmin(static_cast<int>(position), lastBin - 1);
+			const auto fraction = static_cast<float>(position - index);
+
+			level = levels[static_cast<size_t>(index)] + (levels[static_cast<size_t>(index + 1)] - levels[static_cast<size_t>(index)]) * fraction;
+		}
+		else
+		{
+			// Several bins per column at the top: take the loudest, so narrow peaks stay visible
+			level = minDecibels;
+
+			for (auto bin = static_cast<int>(std::ceil(firstBin)); bin < juce::jmin(static_cast<int>(endBin) + 1, lastBin + 1); bin++)
+				level = juce::jmax(level, levels[static_cast<size_t>(bin)]);
+		}
+
+		const auto y = juce::jmap(juce::jlimit(minDecibels, maxDecibels, level), minDecibels, maxDecibels, bounds.getBottom(), bounds.getY());
+
+		if (x == 0)
+			path.startNewSubPath(bounds.getX(), y);
+		else
+			path.lineTo(bounds.getX() + x, y);
+	}
+}
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.h
+
+    Turns the pre-EQ and post-EQ AnalyserFifos into spectrum paths on a
+    background thread, so the editor only has to stroke them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalyserFifo.h"
+
+
+/**
+	Each source is analysed with a Hann-windowed FFT at 50% overlap. The magnitudes
+	are averaged over a selectable number of frames, and the bins are reduced to
+	one point per pixel column on a log frequency axis from 20 Hz to 20 kHz.
+
+	The fifos are only active while an analyser exists and the source is shown,
+	so nothing is pushed from processBlock when the editor is closed.
+*/
+class SpectrumAnalyser  : private juce::Thread
+{
+public:
+	enum Source
+	{
+		PreEq,
+		PostEq,
+		numSources
+	};
+
+	static constexpr int minFftOrder = 10;
+	static constexpr int maxFftOrder = 14;
+
+	SpectrumAnalyser(AnalyserFifo& preEqFifo, AnalyserFifo& postEqFifo);
+	~SpectrumAnalyser() override;
+
+	// All of these are called from the message thread and picked up by the analyser thread.
+	void setFftOrder(int order);
+	int getFftOrder() const { return fftOrder.load(); }
+
+	// Exponential average over about this many frames, 1 for none.
+	void setAveragingFrames(int numFrames);
+	int getAveragingFrames() const { return averagingFrames.load(); }
+
+	void setSourceEnabled(Source source, bool shouldBeEnabled);
+	bool isSourceEnabled(Source source) const;
+
+	// While paused, e.g. with the editor off screen, nothing is pushed or analysed.
+	void setPaused(bool shouldBePaused);
+
+	// The area the paths are laid out in; minDecibels to maxDecibels span its height.
+	void setPlotBounds(juce::Rectangle<float> bounds);
+
+	// True once after new paths were built.
+	bool pullNewPaths() { return newPaths.exchange(false); }
+
+	void strokePath(juce::Graphics& g, Source source, const juce::PathStrokeType& strokeType);
+
+	static constexpr float minDecibels = -90.f;
+	static constexpr float maxDecibels = 0.f;
+
+private:
+	struct Analysis
+	{
+		explicit Analysis(AnalyserFifo& f) : fifo(f) {}
+
+		AnalyserFifo& fifo;
+
+		std::vector<float> history;     // the last fftSize samples
+		std::vector<float> hop;         // samples gathered towards the next frame
+		int numPending = 0;
+
+		std::vector<float> fftData;
+		std::vector<float> averageDecibels;
+		bool hasAverage = false;
+
+		bool wasEnabled = false;        // analyser thread
+		juce::Path workPath;            // analyser thread
+		juce::Path path;                // guarded by pathLock
+	};
+
+	void run() override;
+
+	void applySettings();
+	bool analyse(Analysis& analysis);
+	void performFrame(Analysis& analysis);
+	void buildPath(Analysis& analysis, juce::Rectangle<float> bounds);
+
+	std::array<std::unique_ptr<Analysis>, numSources> analyses;
+
+	std::unique_ptr<juce::dsp::FFT> fft;
+	std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+	int fftSize = 0;                    // analyser thread
+
+	std::atomic<int> fftOrder{ 12 };
+	std::atomic<int> averagingFrames{ 8 };
+	std::array<std::atomic<bool>, numSources> sourceEnabled;
+	std::atomic<bool> paused{ false };
+
+	juce::CriticalSection pathLock;
+	juce::Rectangle<float> plotBounds;   // guarded by pathLock
+	std::atomic<bool> newPaths{ false };
+
+	static constexpr int pollIntervalMs = 15;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyser)
+};
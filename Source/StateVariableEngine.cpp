@@ -0,0 +1,299 @@
+/*
+  ==============================================================================
+
+    StateVariableEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "StateVariableEngine.h"
+#include "CoefficientDesign.h"
+#include "PerformanceProbe.h"
+
+
+namespace
+{
+	// One trapezoidal integration step; v1 is the band-pass and v2 the low-pass output.
+	template <typename SampleType>
+	inline void tick(SampleType& ic1, SampleType& ic2, SampleType x, SampleType a1, SampleType a2, SampleType a3, SampleType& v1, SampleType& v2) noexcept
+	{
+		const auto v3 = x - ic2;
+		v1 = a1 * ic1 + a2 * v3;
+		v2 = ic2 + a2 * ic1 + a3 * v3;
+		ic1 = 2 * v1 - ic1;
+		ic2 = 2 * v2 - ic2;
+	}
+
+	constexpr int peakSection = CutFilter::maxStages;
+	constexpr int firstHiCutSection = CutFilter::maxStages + 1;
+}
+
+
+template <typename SampleType>
+void StateVariableEngine<SampleType>::prepare(double newSampleRate, int newNumChannels, int newMaximumBlockSize)
+{
+	sampleRate = newSampleRate;
+	numChannels = newNumChannels;
+	maximumBlockSize = juce::jmax(1, newMaximumBlockSize);
+
+	for (auto* ramp : { &loCutG, &hiCutG, &peakG, &peakKs, &peakMixes })
+		ramp->assign(static_cast<size_t>(maximumBlockSize), 0.f);
+
+	state.assign(static_cast<size_t>(numChannels * maxSections), {});
+
+	numLoCutSections = numHiCutSections = 0;
+	staticValid = false;
+	ramping = false;
+	peakActive = false;
+}
+
+
+template <typename SampleType>
+void StateVariableEngine<SampleType>::reset()
+{
+	std::fill(state.begin(), state.end(), Integrators{});
+}
+
+
+template <typename SampleType>
+float StateVariableEngine<SampleType>::getG(float frequency) const noexcept
+{
+	// tan() runs off to infinity at Nyquist
+	return getPrewarpedCutoff(sampleRate, juce::jlimit(2.f, static_cast<float>(sampleRate * 0.49), frequency));
+}
+
+
+template <typename SampleType>
+void StateVariableEngine<SampleType>::setSlopes(int loCutSlope, int hiCutSlope) noexcept
+{
+	auto update = [this](int slope, std::array<float, CutFilter::maxStages>& k, int& numSections, int firstSection)
+	{
+		const auto order = getCutFilterOrder(slope);
+		const auto newNumSections = order / 2;
+
+		if (newNumSections == numSections)
+			return;
+
+		for (int i = 0; i < newNumSections; i++)
+			k[static_cast<size_t>(i)] = getButterworthSectionDamping(order, i);
+
+		// Sections that join the cascade start from silence
+		for (int ch = 0; ch < numChannels; ch++)
+			for (int i = numSections; i < newNumSections; i++)
+				state[static_cast<size_t>(ch * maxSections + firstSection + i)] = {};
+
+		numSections = newNumSections;
+		staticValid = false;
+	};
+
+	update(loCutSlope, loCutK, numLoCutSections, 0);
+	update(hiCutSlope, hiCutK, numHiCutSections, firstHiCutSection);
+}
+
+
+template <typename SampleType>
+void StateVariableEngine<SampleType>::updateStaticCoefficients(const ChainSettings& settings) noexcept
+{
+	const auto loCutGValue = getG(settings.loCutFreq);
+	for (int i = 0; i < numLoCutSections; i++)
+		loCut[static_cast<size_t>(i)] = makeCoefficients(loCutGValue, loCutK[static_cast<size_t>(i)]);
+
+	const auto hiCutGValue = getG(settings.hiCutFreq);
+	for (int i = 0; i < numHiCutSections; i++)
+		hiCut[static_cast<size_t>(i)] = makeCoefficients(hiCutGValue, hiCutK[static_cast<size_t>(i)]);
+
+	const auto A = std::pow(10.f, settings.peakGain / 40.f);
+	const auto k = 1 / (settings.peakQ * A);
+	peakK = k;
+	peakMix = k * (A * A - 1);
+	peak = makeCoefficients(getG(settings.peakFreq), peakK);
+
+	staticSettings = settings;
+	staticValid = true;
+}
+
+
+template <typename SampleType>
+void StateVariableEngine<SampleType>::setRamp(const ChainSettings& from, const ChainSettings& to, int numSamples) noexcept
+{
+	setSlopes(to.loCutSlope, to.hiCutSlope);
+
+	const auto loCutMoves = from.loCutFreq != to.loCutFreq;
+	const auto hiCutMoves = from.hiCutFreq != to.hiCutFreq;
+	const auto peakMoves = from.peakFreq != to.peakFreq || from.peakGain != to.peakGain || from.peakQ != to.peakQ;
+
+	ramping = loCutMoves || hiCutMoves || peakMoves;
+
+	if (ramping)
+	{
+		jassert(numSamples <= maximumBlockSize);
+		const auto n = juce::jlimit(1, maximumBlockSize, numSamples);
+
+		// Sample i gets the value after i + 1 steps, as SmoothedValue::getNextValue() would
+		auto fillCut = [this, n](std::vector<float>& g, float start, float end)
+		{
+			if (start == end)
+			{
+				std::fill_n(g.begin(), n, getG(end));
+				return;
+			}
+
+			const auto step = std::pow(end / start, 1.f / n);
+			auto frequency = start;
+
+			for (int i = 0; i < n; i++)
+			{
+				frequency *= step;
+				g[static_cast<size_t>(i)] = getG(frequency);
+			}
+		};
+
+		fillCut(loCutG, from.loCutFreq, to.loCutFreq);
+		fillCut(hiCutG, from.hiCutFreq, to.hiCutFreq);
+
+		const auto frequencyStep = std::pow(to.peakFreq / from.peakFreq, 1.f / n);
+		const auto qStep = std::pow(to.peakQ / from.peakQ, 1.f / n);
+		const auto aStep = std::pow(10.f, (to.peakGain - from.peakGain) / (40.f * n));
+
+		auto frequency = from.peakFreq;
+		auto q = from.peakQ;
+		auto A = std::pow(10.f, from.peakGain / 40.f);
+
+		for (int i = 0; i < n; i++)
+		{
+			frequency *= frequencyStep;
+			q *= qStep;
+			A *= aStep;
+
+			const auto k = 1 / (q * A);
+			peakG[static_cast<size_t>(i)] = getG(frequency);
+			peakKs[static_cast<size_t>(i)] = k;
+			peakMixes[static_cast<size_t>(i)] = k * (A * A - 1);
+		}
+	}
+
+	auto settingsDiffer = [](const ChainSettings& a, const ChainSettings& b)
+	{
+		return a.loCutFreq != b.loCutFreq || a.hiCutFreq != b.hiCutFreq
+		    || a.peakFreq != b.peakFreq || a.peakGain != b.peakGain || a.peakQ != b.peakQ;
+	};
+
+	// Where the next block without ramps carries on from
+	if (!staticValid || settingsDiffer(staticSettings, to))
+		updateStaticCoefficients(to);
+
+	// A bell at 0 dB is transparent and is not run; it restarts from silence when it comes back
+	const auto wasActive = peakActive;
+	peakActive = peakMoves || peakMix != 0;
+
+	if (peakActive && !wasActive)
+		for (int ch = 0; ch < numChannels; ch++)
+			state[static_cast<size_t>(ch * maxSections + peakSection)] = {};
+}
+
+
+template <typename SampleType>
+void StateVariableEngine<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block, int firstChannel, std::array<juce::uint64, 3>* stageTicks) noexcept
+{
+	const auto numSamples = static_cast<int>(block.getNumSamples());
+	const auto channelsInBlock = juce::jmin(static_cast<int>(block.getNumChannels()), numChannels - firstChannel);
+
+	jassert(!ramping || numSamples <= maximumBlockSize);
+
+	for (int ch = 0; ch < channelsInBlock; ch++)
+	{
+		auto* data = block.getChannelPointer(static_cast<size_t>(ch));
+		auto* channelState = state.data() + (firstChannel + ch) * maxSections;
+
+		if (stageTicks != nullptr)
+		{
+			if (ramping)
+				processChannelTimed<true>(data, channelState, juce::jmin(numSamples, maximumBlockSize), *stageTicks);
+			else
+				processChannelTimed<false>(data, channelState, numSamples, *stageTicks);
+		}
+		else if (ramping)
+			processChannel<true>(data, channelState, juce::jmin(numSamples, maximumBlockSize));
+		else
+			processChannel<false>(data, channelState, numSamples);
+
+		for (int s = 0; s < maxSections; s++)
+		{
+			JUCE_SNAP_TO_ZERO(channelState[s].ic1);
+			JUCE_SNAP_TO_ZERO(channelState[s].ic2);
+		}
+	}
+}
+
+
+template <typename SampleType>
+template <bool Ramping, bool RunLoCut, bool RunPeak, bool RunHiCut>
+void StateVariableEngine<SampleType>::processChannel(SampleType* data, Integrators* channelState, int numSamples) noexcept
+{
+	auto* loCutState = channelState;
+	auto& peakState = channelState[peakSection];
+	auto* hiCutState = channelState + firstHiCutSection;
+
+	SampleType v1, v2;
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		auto x = data[i];
+
+		for (int s = 0; s < (RunLoCut ? numLoCutSections : 0); s++)
+		{
+			const auto c = Ramping ? makeCoefficients(loCutG[static_cast<size_t>(i)], loCutK[static_cast<size_t>(s)]) : loCut[static_cast<size_t>(s)];
+			tick(loCutState[s].ic1, loCutState[s].ic2, x, c.a1, c.a2, c.a3, v1, v2);
+			x = x - loCutK[static_cast<size_t>(s)] * v1 - v2;
+		}
+
+		if (RunPeak && peakActive)
+		{
+			const SampleType k = Ramping ? peakKs[static_cast<size_t>(i)] : peakK;
+			const SampleType mix = Ramping ? peakMixes[static_cast<size_t>(i)] : peakMix;
+			const auto c = Ramping ? makeCoefficients(peakG[static_cast<size_t>(i)], k) : peak;
+
+			tick(peakState.ic1, peakState.ic2, x, c.a1, c.a2, c.a3, v1, v2);
+			x = x + mix * v1;
+		}
+
+		for (int s = 0; s < (RunHiCut ? numHiCutSections : 0); s++)
+		{
+			const auto c = Ramping ? makeCoefficients(hiCutG[static_cast<size_t>(i)], hiCutK[static_cast<size_t>(s)]) : hiCut[static_cast<size_t>(s)];
+			tick(hiCutState[s].ic1, hiCutState[s].ic2, x, c.a1, c.a2, c.a3, v1, v2);
+			x = v2;
+		}
+
+		data[i] = x;
+	}
+}
+
+
+// Each section only depends on the output of the one before it, so running the groups one
+// after the other over the whole channel gives the same samples as interleaving them.
+template <typename SampleType>
+template <bool Ramping>
+void StateVariableEngine<SampleType>::processChannelTimed(SampleType* data, Integrators* channelState, int numSamples, std::array<juce::uint64, 3>& ticks) noexcept
+{
+	auto start = PerformanceProbe::now();
+
+	auto addTicks = [&start, &ticks](ChainPositions position)
+	{
+		const auto end = PerformanceProbe::now();
+		ticks[static_cast<size_t>(position)] += end - start;
+		start = end;
+	};
+
+	processChannel<Ramping, true, false, false>(data, channelState, numSamples);
+	addTicks(ChainPositions::LoCut);
+
+	processChannel<Ramping, false, true, false>(data, channelState, numSamples);
+	addTicks(ChainPositions::Peak);
+
+	processChannel<Ramping, false, false, true>(data, channelState, numSamples);
+	addTicks(ChainPositions::HiCut);
+}
+
+
+template class StateVariableEngine<float>;
+template class StateVariableEngine<double>;
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    StateVariableEngine.h
+
+    LoCut -> Peak -> HiCut built from topology-preserving state variable
+    filters, as an alternative to the biquad backends for heavily
+    automated material.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterChain.h"
+
+
+/**
+	Every section is a trapezoidal (TPT) state variable filter in the form given by
+	Zavalishin and Simper. Its coefficients are g = tan(pi f / fs) and k = 1 / Q, and
+	the three outputs are mixed for the response:
+
+		high-pass   x - k v1 - v2
+		low-pass    v2
+		bell        x + k (A^2 - 1) v1,  with k = 1 / (Q A), A = 10^(dB / 40)
+
+	These are the bilinear transforms, prewarped at the cutoff, of the same analog
+	prototypes that juce::dsp::IIR::Coefficients uses, so the magnitude responses
+	match the biquad designs in FilterChain.h. The Butterworth cuts use the same
+	per-section Q values as the biquad cascades.
+
+	A frequency change costs one tan per sample and section group, and the state
+	is the integrators' charge, so the filter stays stable under audio-rate
+	modulation where a direct form biquad would not.
+
+	setRamp() is called once per block, before the channel groups run. When the
+	parameters move, the per-sample values of g and the bell coefficients are worked
+	out once into preallocated buffers and shared by all channels.
+
+	Instantiated for float and double. The double one works out g and k in float
+	like the biquad designers and keeps its integrators and mixes in double.
+*/
+template <typename SampleType>
+class StateVariableEngine
+{
+public:
+	static constexpr int maxSections = 2 * CutFilter::maxStages + 1;
+
+	// Not real-time safe. maximumBlockSize is also the longest ramp setRamp() accepts.
+	void prepare(double sampleRate, int numChannels, int maximumBlockSize);
+	void reset();
+
+	int getMaximumBlockSize() const { return maximumBlockSize; }
+
+	// Audio thread. Ramps from `from` to `to` over the next numSamples samples, with the
+	// frequencies and Q moving geometrically and the gain linearly in dB, like the
+	// processor's smoothers. Pass the same settings twice for a block without ramps.
+	void setRamp(const ChainSettings& from, const ChainSettings& to, int numSamples) noexcept;
+
+	// Processes the channels of the block as channels firstChannel, firstChannel + 1, ...
+	// The block must not be longer than the ramp set up before it. With stageTicks, the
+	// sections run one group at a time and each group's counter ticks are added to the
+	// entry of its ChainPositions, as the profiler reports them.
+	void process(const juce::dsp::AudioBlock<SampleType>& block, int firstChannel, std::array<juce::uint64, 3>* stageTicks = nullptr) noexcept;
+
+private:
+	struct Integrators
+	{
+		SampleType ic1 = 0, ic2 = 0;
+	};
+
+	struct SectionCoefficients
+	{
+		SampleType a1, a2, a3;
+	};
+
+	static SectionCoefficients makeCoefficients(SampleType g, SampleType k) noexcept
+	{
+		const auto a1 = 1 / (1 + g * (g + k));
+		return { a1, g * a1, g * g * a1 };
+	}
+
+	float getG(float frequency) const noexcept;
+	void setSlopes(int loCutSlope, int hiCutSlope) noexcept;
+	void updateStaticCoefficients(const ChainSettings& settings) noexcept;
+
+	template <bool Ramping, bool RunLoCut = true, bool RunPeak = true, bool RunHiCut = true>
+	void processChannel(SampleType* data, Integrators* channelState, int numSamples) noexcept;
+
+	template <bool Ramping>
+	void processChannelTimed(SampleType* data, Integrators* channelState, int numSamples, std::array<juce::uint64, 3>& ticks) noexcept;
+
+	double sampleRate = 44100;
+	int numChannels = 0;
+	int maximumBlockSize = 0;
+
+	// Cut sections: k = 1 / Q of each Butterworth section
+	std::array<float, CutFilter::maxStages> loCutK{}, hiCutK{};
+	int numLoCutSections = 0, numHiCutSections = 0;
+
+	// Static coefficients, used while nothing ramps
+	std::array<SectionCoefficients, CutFilter::maxStages> loCut{}, hiCut{};
+	SectionCoefficients peak{};
+	SampleType peakK = 0, peakMix = 0;
+	ChainSettings staticSettings;
+	bool staticValid = false;
+
+	// Per-sample values while ramping
+	bool ramping = false;
+	std::vector<float> loCutG, hiCutG, peakG, peakKs, peakMixes;
+
+	// Indexed [channel * maxSections + section]: LoCut sections, then the peak, then HiCut
+	std::vector<Integrators> state;
+	bool peakActive = false;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StateVariableEngine)
+};